@@ -24,41 +24,57 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include <cassert>
 #include <stdlib.h>
 #include <cstdint>
+#include <sys/mman.h>
 
 namespace Qute {
 
 class OutOfMemoryException{};
 
+// Arenas are indexed by 32-bit words. Building with LARGE_ARENAS lifts the resulting 2^32 word limit.
+#ifdef LARGE_ARENAS
+typedef uint64_t ArenaIndex;
+#else
+typedef uint32_t ArenaIndex;
+#endif
+
+/* With the mmap policy, an arena reserves the address space for its maximal size up front and
+   lets the kernel back it with (transparent huge) pages on first touch, so it never has to be copied. */
+enum class ArenaPolicy { malloc, mmap };
+
 //=================================================================================================
 // Simple Region-based memory allocator:
 
 template<class T>
 class RegionAllocator
 {
-    T*        memory;
-    uint32_t  sz;
-    uint32_t  cap;
-    uint32_t  wasted_;
+    T*          memory;
+    ArenaIndex  sz;
+    ArenaIndex  cap;
+    ArenaIndex  wasted_;
+    ArenaPolicy policy;
 
-    void capacity(uint32_t min_cap);
+    void capacity(ArenaIndex min_cap);
+    void allocateCapacity();
+    void release();
+    static size_t reservedBytes();
 
  public:
-    typedef uint32_t Ref;
-    enum { Ref_Undef = UINT32_MAX };
+    typedef ArenaIndex Ref;
+    static const Ref Ref_Undef = ~Ref(0);
     enum { Unit_Size = sizeof(T) };
 
-    explicit RegionAllocator(uint32_t start_cap = 1024*1024) : memory(nullptr), sz(0), cap(0), wasted_(0){ capacity(start_cap); }
+    explicit RegionAllocator(ArenaIndex start_cap = 1024*1024, ArenaPolicy policy = ArenaPolicy::malloc) : memory(nullptr), sz(0), cap(0), wasted_(0), policy(policy){ capacity(start_cap); }
     ~RegionAllocator()
     {
-        if (memory != nullptr)
-            ::free(memory);
+        release();
     }
 
 
-    uint32_t size      () const      { return sz; }
-    uint32_t wasted    () const      { return wasted_; }
+    Ref      size      () const      { return sz; }
+    Ref      wasted    () const      { return wasted_; }
 
     Ref      alloc     (int size);
+    void     reserve   (uint64_t min_cap);
     void     free      (int size)    { wasted_ += size; }
 
     // Deref, Load Effective Address (LEA), Inverse of LEA (AEL):
@@ -71,11 +87,12 @@ class RegionAllocator
         return  (Ref)(t - &memory[0]); }
 
     void     moveTo(RegionAllocator& to) {
-        if (to.memory != nullptr) ::free(to.memory);
+        to.release();
         to.memory = memory;
         to.sz = sz;
         to.cap = cap;
         to.wasted_ = wasted_;
+        to.policy = policy;
 
         memory = nullptr;
         sz = cap = wasted_ = 0;
@@ -85,25 +102,82 @@ class RegionAllocator
 };
 
 template<class T>
-void RegionAllocator<T>::capacity(uint32_t min_cap)
+size_t RegionAllocator<T>::reservedBytes()
+{
+#ifdef LARGE_ARENAS
+    return size_t(1) << 40;
+#else
+    return (size_t(1) << 32) * sizeof(T);
+#endif
+}
+
+template<class T>
+void RegionAllocator<T>::release()
+{
+    if (memory == nullptr) return;
+    if (policy == ArenaPolicy::mmap)
+        munmap(memory, reservedBytes());
+    else
+        ::free(memory);
+    memory = nullptr;
+}
+
+template<class T>
+void RegionAllocator<T>::capacity(ArenaIndex min_cap)
 {
     if (cap >= min_cap) return;
 
-    uint32_t prev_cap = cap;
+    ArenaIndex prev_cap = cap;
     while (cap < min_cap){
         // NOTE: Multiply by a factor (13/8) without causing overflow, then add 2 and make the
         // result even by clearing the least significant bit. The resulting sequence of capacities
         // is carefully chosen to hit a maximum capacity that is close to the '2^32-1' limit when
         // using 'uint32_t' as indices so that as much as possible of this space can be used.
-        uint32_t delta = ((cap >> 1) + (cap >> 3) + 2) & ~1;
+        ArenaIndex delta = ((cap >> 1) + (cap >> 3) + 2) & ~1;
         cap += delta;
 
         if (cap <= prev_cap)
             throw OutOfMemoryException();
     }
     // printf(" .. (%p) cap = %u\n", this, cap);
+    allocateCapacity();
+}
 
+template<class T>
+void RegionAllocator<T>::reserve(uint64_t min_cap)
+{
+    // Unlike capacity, grows the arena to exactly min_cap, for sizes that are known in advance.
+    if (cap >= min_cap) return;
+    if (min_cap > ArenaIndex(~ArenaIndex(0)))
+        throw OutOfMemoryException();
+    cap = min_cap;
+    allocateCapacity();
+}
+
+template<class T>
+void RegionAllocator<T>::allocateCapacity()
+{
     assert(cap > 0);
+    if (policy == ArenaPolicy::mmap) {
+        if (memory == nullptr) {
+            void* reservation = mmap(nullptr, reservedBytes(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+            if (reservation == MAP_FAILED) {
+                // Address space is limited, fall back to growing the arena with realloc.
+                policy = ArenaPolicy::malloc;
+            } else {
+#ifdef MADV_HUGEPAGE
+                madvise(reservation, reservedBytes(), MADV_HUGEPAGE);
+#endif
+                memory = (T*)reservation;
+            }
+        }
+        if (policy == ArenaPolicy::mmap) {
+            if (sizeof(T)*size_t(cap) > reservedBytes())
+                throw OutOfMemoryException();
+            return;
+        }
+    }
+    // Arenas beyond the mmap threshold of the C library are grown by remapping pages rather than copying.
     memory = (T*)realloc(memory, sizeof(T)*cap);
     if (memory == nullptr) {
       throw OutOfMemoryException();
@@ -118,7 +192,7 @@ RegionAllocator<T>::alloc(int size)
     assert(size > 0);
     capacity(sz + size);
 
-    uint32_t prev_sz = sz;
+    ArenaIndex prev_sz = sz;
     sz += size;
 
     // Handle overflow:
@@ -23,6 +23,7 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 
 #include <vector>
 #include <iostream>
+#include <cstring>
 
 #include "alloc.hh"
 #include "solver_types.hh"
@@ -32,53 +33,76 @@ using std::ostream;
 namespace Qute {
 
 // Constraint class (clauses & terms).
+/* Learnt constraints store their activity and LBD right after the header and before the literals, so that
+   reducing the learnt constraints only touches the first words of each constraint. Long constraints
+   additionally store the position at which the last search for a new watcher ended. The optional trace id
+   is cold and therefore stored after the literals. */
 struct Constraint
 {
-  unsigned size: 29;
+  unsigned size: 26;
   unsigned marked: 1;
   unsigned learnt: 1;
   unsigned is_reloced: 1;
-  union { Literal lit; float activity; uint32_t LBD; CRef rel; uint32_t id; } data[0];
+  unsigned tier: 2; // Retention tier of a learnt constraint, see ConstraintDB.
+  unsigned used: 1; // Whether a learnt constraint took part in conflict analysis since the last tier-2 reduction.
+  union { Literal lit; float activity; uint32_t LBD; uint32_t search_position; uint32_t id; } data[0];
 
   friend class ConstraintAllocator;
 
-  Literal& operator [] (int i) { return data[i].lit; }
-  Literal operator [] (int i) const { return data[i].lit; }
+  Literal& operator [] (int i) { return data[literalsOffset() + i].lit; }
+  Literal operator [] (int i) const { return data[literalsOffset() + i].lit; }
 
-  Literal* begin() { return &data[0].lit; }
-  Literal* end() { return &data[size].lit; }
+  Literal* begin() { return &data[literalsOffset()].lit; }
+  Literal* end() { return &data[literalsOffset() + size].lit; }
 
   bool         isMarked    ()      const   { return marked; }
   void         mark        ()              { marked = 1; }
   void         unmark      ()              { marked = 0; }
   bool         reloced     ()      const   { return is_reloced; }
-  CRef         relocation  ()      const   { return data[0].rel; }
-  void         relocate    (CRef cr)        { is_reloced = true; data[0].rel = cr; }
-  float&       activity    ()              { return data[size].activity; }
-  uint32_t&    LBD         ()              { return data[size + 1].LBD; }
-  uint32_t&    id          ()              { return data[size + 2 * learnt].id; }
-
-  Constraint(const Constraint& other, bool has_id): size(other.size), marked(false), learnt(other.learnt), is_reloced(false) {
-    for (uint32_t i = 0; i < other.size; i++) {
-      data[i].lit = other[i];
-    }
+  // Only learnt constraints are relocated, their activity and LBD words leave room for a 64-bit reference.
+  CRef         relocation  ()      const   { CRef cr; memcpy(&cr, data, sizeof(CRef)); return cr; }
+  void         relocate    (CRef cr)        { assert(learnt); is_reloced = true; memcpy(data, &cr, sizeof(CRef)); }
+  float&       activity    ()              { return data[0].activity; }
+  uint32_t&    LBD         ()              { return data[1].LBD; }
+  uint32_t&    id          ()              { return data[literalsOffset() + size].id; }
+  bool         hasSearchPosition()  const  { return hasSearchPosition(size); }
+  uint32_t&    searchPosition()            { assert(hasSearchPosition()); return data[learnt << 1].search_position; }
+
+  // Searching for watchers from a saved position only pays off for constraints with more than one candidate.
+  static bool  hasSearchPosition(uint32_t size) { return size > 3; }
+
+  Constraint(const Constraint& other, bool has_id): size(other.size), marked(false), learnt(other.learnt), is_reloced(false), tier(other.tier), used(other.used) {
     if (learnt) {
-      data[size].activity = const_cast<Constraint&>(other).activity();
-      data[size + 1].LBD = const_cast<Constraint&>(other).LBD();
+      data[0].activity = const_cast<Constraint&>(other).activity();
+      data[1].LBD = const_cast<Constraint&>(other).LBD();
+    }
+    if (hasSearchPosition()) {
+      searchPosition() = const_cast<Constraint&>(other).searchPosition();
+    }
+    for (uint32_t i = 0; i < other.size; i++) {
+      (*this)[i] = other[i];
     }
     if (has_id) {
-      data[size + 2 * learnt].id = const_cast<Constraint&>(other).id();
+      id() = const_cast<Constraint&>(other).id();
     }
   }
 
-  Constraint(const vector<Literal>& literals, bool learnt=false): size(literals.size()), marked(false), learnt(learnt), is_reloced(false) {
-    for (uint32_t i = 0; i < literals.size(); i++) {
-      data[i].lit = literals[i];
-    }
+  Constraint(const Literal* literals, uint32_t size, bool learnt=false): size(size), marked(false), learnt(learnt), is_reloced(false), tier(0), used(0) {
     if (learnt) {
-      data[size].activity = 0;
+      data[0].activity = 0;
+    }
+    if (hasSearchPosition()) {
+      searchPosition() = 2;
+    }
+    for (uint32_t i = 0; i < size; i++) {
+      (*this)[i] = literals[i];
     }
   }
+
+  Constraint(const vector<Literal>& literals, bool learnt=false): Constraint(literals.data(), literals.size(), learnt) {}
+
+private:
+  uint32_t     literalsOffset()    const   { return (learnt << 1) + hasSearchPosition(); }
 };
 
 inline ostream& operator << (ostream& os, Constraint& constraint) {
@@ -94,36 +118,64 @@ class ConstraintAllocator
     RegionAllocator<uint32_t> ra;
     // If tracing is activated we need to allocate an extra 32 bits for the id.
     bool print_trace = false;
-    // For learnt constraints, we additionally store both its LBD and activity.
+    // For learnt constraints, we additionally store both its LBD and activity, for long constraints a search position.
     static uint32_t constraintWord32Size(int size, bool learnt=false, bool has_id=false) {
-        return (sizeof(Constraint) + (sizeof(int32_t) * (size + 2 * learnt + has_id))) / sizeof(uint32_t); }
+        return (sizeof(Constraint) + (sizeof(int32_t) * (size + 2 * learnt + Constraint::hasSearchPosition(size) + has_id))) / sizeof(uint32_t); }
+
+    /* Learnt constraints start at a multiple of this many words, so that the header, activity and LBD
+       never straddle a cache line. Padding is not counted as wasted, since compaction cannot recover it. */
+    static const uint32_t learnt_alignment = 4;
+
+    void alignLearnt() {
+        uint32_t padding = (learnt_alignment - ra.size() % learnt_alignment) % learnt_alignment;
+        if (padding > 0) {
+            ra.alloc(padding);
+        }
+    }
 
  public:
     enum { Unit_Size = RegionAllocator<uint32_t>::Unit_Size };
 
-    ConstraintAllocator(uint32_t start_cap, bool print_trace): ra(start_cap), print_trace(print_trace) {}
-    ConstraintAllocator(bool print_trace): print_trace(print_trace) {}
+    ConstraintAllocator(ArenaIndex start_cap, bool print_trace, ArenaPolicy policy=ArenaPolicy::malloc): ra(start_cap, policy), print_trace(print_trace) {}
+    ConstraintAllocator(bool print_trace, ArenaPolicy policy=ArenaPolicy::malloc): ra(1024*1024, policy), print_trace(print_trace) {}
 
     void moveTo(ConstraintAllocator& to){
         ra.moveTo(to.ra); }
 
     CRef alloc(const vector<Literal>& literals, bool learnt=false)
+    {
+        return alloc(literals.data(), literals.size(), learnt);
+    }
+
+    CRef alloc(const Literal* literals, uint32_t size, bool learnt=false)
     {
         assert(sizeof(Literal) == sizeof(uint32_t));
-        CRef cid       = ra.alloc(constraintWord32Size(literals.size(), learnt, print_trace));
-        new (lea(cid)) Constraint(literals, learnt);
+        if (learnt) {
+            alignLearnt();
+        }
+        CRef cid       = ra.alloc(constraintWord32Size(size, learnt, print_trace));
+        new (lea(cid)) Constraint(literals, size, learnt);
 
         return cid;
     }
 
     CRef alloc(const Constraint& from)
     {
+        if (from.learnt) {
+            alignLearnt();
+        }
         CRef cid       = ra.alloc(constraintWord32Size(from.size, from.learnt, print_trace));
         new (lea(cid)) Constraint(from, print_trace);
         return cid; }
 
-    uint32_t size      () const      { return ra.size(); }
-    uint32_t wasted    () const      { return ra.wasted(); }
+    // Grows the arena to exactly the given number of words in total, see wordSize.
+    void reserve(uint64_t min_cap) {
+        ra.reserve(min_cap); }
+    uint32_t wordSize(uint32_t size, bool learnt=false) const {
+        return constraintWord32Size(size, learnt, print_trace); }
+
+    CRef     size      () const      { return ra.size(); }
+    CRef     wasted    () const      { return ra.wasted(); }
 
     // Deref, Load Effective Address (LEA), Inverse of LEA (AEL):
     Constraint&       operator[](CRef r)         { return (Constraint&)ra[r]; }
@@ -2,50 +2,108 @@
 
 namespace Qute {
 
-ConstraintDB::ConstraintDB(QCDCL_solver& solver, bool print_trace, double constraint_activity_decay, uint32_t max_learnt_clauses, uint32_t max_learnt_terms, uint32_t learnt_clauses_increment, uint32_t learnt_terms_increment, double clause_removal_ratio, double term_removal_ratio, bool use_activity_threshold, double constraint_increment, uint32_t LBD_threshold): removal_ratio{clause_removal_ratio, term_removal_ratio}, solver(solver), print_trace(print_trace), constraints{ConstraintAllocator(print_trace), ConstraintAllocator(print_trace)}, constraint_inc{constraint_increment, constraint_increment}, constraint_activity_decay(constraint_activity_decay), learnts_max{max_learnt_clauses, max_learnt_terms}, learnts_increment{learnt_clauses_increment, learnt_terms_increment}, ca_to(nullptr), use_activity_threshold(use_activity_threshold), LBD_threshold(LBD_threshold) {}
+ConstraintDB::ConstraintDB(QCDCL_solver& solver, bool print_trace, double constraint_activity_decay, uint32_t max_learnt_clauses, uint32_t max_learnt_terms, uint32_t learnt_clauses_increment, uint32_t learnt_terms_increment, double clause_removal_ratio, double term_removal_ratio, bool use_activity_threshold, double constraint_increment, uint32_t LBD_threshold, uint32_t tier2_LBD_threshold, uint32_t tier2_interval, bool decreasing_LBD, ArenaPolicy arena_policy): removal_ratio{clause_removal_ratio, term_removal_ratio}, solver(solver), print_trace(print_trace), arena_policy(arena_policy), input_constraints{ConstraintAllocator(print_trace, arena_policy), ConstraintAllocator(print_trace, arena_policy)}, learnt_constraints{ConstraintAllocator(print_trace, arena_policy), ConstraintAllocator(print_trace, arena_policy)}, literal_occurrences{vector<vector<CRef>>(Min_Literal_Int), vector<vector<CRef>>(Min_Literal_Int)}, constraint_inc{constraint_increment, constraint_increment}, constraint_activity_decay(constraint_activity_decay), learnts_max{max_learnt_clauses, max_learnt_terms}, learnts_increment{learnt_clauses_increment, learnt_terms_increment}, ca_to(nullptr), use_activity_threshold(use_activity_threshold), LBD_threshold(LBD_threshold), tier2_LBD_threshold(tier2_LBD_threshold), tier2_interval(tier2_interval), conflicts_since_tier2_reduction{0, 0}, nr_learnts_in_tier{{0, 0, 0}, {0, 0, 0}}, decreasing_LBD(decreasing_LBD), current_level_stamp(0) {}
 
 CRef ConstraintDB::addConstraint(vector<Literal>& literals, ConstraintType constraint_type, bool learnt) {
-  CRef constraint_reference = constraints[constraint_type].alloc(literals, learnt);
+  CRef constraint_reference = learnt ? learnt_constraints[constraint_type].alloc(literals, learnt): input_constraints[constraint_type].alloc(literals, learnt);
+  if (constraint_reference & learnt_reference_flag) {
+    // The most significant bit of a constraint reference is reserved for distinguishing learnt constraints.
+    throw OutOfMemoryException();
+  }
   if (learnt) {
+    constraint_reference |= learnt_reference_flag;
     learnt_constraint_references[constraint_type].push_back(constraint_reference);
     Constraint& constraint = getConstraint(constraint_reference, constraint_type);
-    updateLBD(constraint);
+    constraint.LBD() = computeLBD(constraint);
+    constraint.tier = tierForLBD(constraint.LBD());
+    nr_learnts_in_tier[constraint_type][constraint.tier]++;
     bumpConstraintActivity(constraint, constraint_type);
   } else {
     input_constraint_references[constraint_type].push_back(constraint_reference);
-    for (Literal l: literals) {
-      literal_occurrences[constraint_type][l].push_back(constraint_reference);
-    }
   }
-  LOG(trace) << (learnt ? "Learnt ": "Input ") << (constraint_type ? "term": "clause") << ": " << constraints[constraint_type][constraint_reference] << std::endl;
+  LOG(trace) << (learnt ? "Learnt ": "Input ") << (constraint_type ? "term": "clause") << ": " << getConstraint(constraint_reference, constraint_type) << std::endl;
   return constraint_reference;
 }
 
-void ConstraintDB::updateLBD(Constraint& constraint) {
-  vector<bool> levels(solver.variable_data_store->decisionLevel() + 1);
-  std::fill(levels.begin(), levels.end(), false);
+void ConstraintDB::addConstraints(const ConstraintBatch& batch, ConstraintType constraint_type) {
+  // The arena is grown once, to exactly fit the constraints it already holds and the batch.
+  uint64_t nr_words = 0;
+  for (uint32_t i = 0; i < batch.size(); i++) {
+    nr_words += input_constraints[constraint_type].wordSize(batch.constraintSize(i));
+  }
+  input_constraints[constraint_type].reserve(input_constraints[constraint_type].size() + nr_words);
+  input_constraint_references[constraint_type].reserve(input_constraint_references[constraint_type].size() + batch.size());
+  for (uint32_t i = 0; i < batch.size(); i++) {
+    CRef constraint_reference = input_constraints[constraint_type].alloc(batch.constraintBegin(i), batch.constraintSize(i));
+    if (constraint_reference & learnt_reference_flag) {
+      throw OutOfMemoryException();
+    }
+    input_constraint_references[constraint_type].push_back(constraint_reference);
+    LOG(trace) << "Input " << (constraint_type ? "term": "clause") << ": " << getConstraint(constraint_reference, constraint_type) << std::endl;
+  }
+}
+
+void ConstraintDB::notifyStart() {
+  // The occurrence lists are built in one pass over the input constraints, after counting the occurrences of each literal.
+  for (ConstraintType constraint_type: constraint_types) {
+    vector<uint32_t> nr_occurrences(literal_occurrences[constraint_type].size(), 0);
+    for (CRef constraint_reference: input_constraint_references[constraint_type]) {
+      for (Literal l: getConstraint(constraint_reference, constraint_type)) {
+        nr_occurrences[toInt(l)]++;
+      }
+    }
+    for (unsigned literal_int = Min_Literal_Int; literal_int < nr_occurrences.size(); literal_int++) {
+      literal_occurrences[constraint_type][literal_int].reserve(nr_occurrences[literal_int]);
+    }
+    for (CRef constraint_reference: input_constraint_references[constraint_type]) {
+      for (Literal l: getConstraint(constraint_reference, constraint_type)) {
+        literal_occurrences[constraint_type][toInt(l)].push_back(constraint_reference);
+      }
+    }
+  }
+}
+
+void ConstraintDB::updateLBD(Constraint& constraint, ConstraintType constraint_type) {
+  constraint.used = 1;
+  if (!decreasing_LBD) {
+    constraint.LBD() = computeLBD(constraint);
+  } else if (constraint.LBD() > LBD_threshold) {
+    /* As in Glucose, the LBD is only ever decreased, so counting can stop as soon as it reaches the current value.
+       Constraints with an LBD of at most LBD_threshold are never removed, so their LBD need not be maintained. */
+    uint32_t nr_levels = computeLBD(constraint, constraint.LBD());
+    if (nr_levels < constraint.LBD()) {
+      constraint.LBD() = nr_levels;
+    }
+  }
+  // Constraints are promoted when their LBD decreases, but an increased LBD does not demote them.
+  LearntTier tier = tierForLBD(constraint.LBD());
+  if (tier < constraint.tier) {
+    setTier(constraint, constraint_type, tier);
+  }
+}
+
+uint32_t ConstraintDB::computeLBD(Constraint& constraint, uint32_t bound) {
+  // Decision levels are marked by stamping them with a fresh value, so no per-call reset is needed.
+  if (level_stamps.size() < solver.variable_data_store->decisionLevel() + 1) {
+    level_stamps.resize(solver.variable_data_store->decisionLevel() + 1, 0);
+  }
+  current_level_stamp++;
   uint32_t nr_levels = 0;
   for (Literal l: constraint) {
     Variable v = var(l);
-    if (solver.variable_data_store->isAssigned(v) && !levels[solver.variable_data_store->varDecisionLevel(v)]) {
-      levels[solver.variable_data_store->varDecisionLevel(v)] = true;
+    if (solver.variable_data_store->isAssigned(v) && level_stamps[solver.variable_data_store->varDecisionLevel(v)] != current_level_stamp) {
+      level_stamps[solver.variable_data_store->varDecisionLevel(v)] = current_level_stamp;
       nr_levels++;
+      if (nr_levels >= bound) {
+        break;
+      }
     }
   }
-  constraint.LBD() = nr_levels;
+  return nr_levels;
 }
 
 void ConstraintDB::relocConstraintReferences(ConstraintType constraint_type) {
-  for (auto it = literal_occurrences[constraint_type].begin(); it != literal_occurrences[constraint_type].end(); ++it) {
-    for (CRef& constraint_reference: it->second) {
-      /* Since literal occurrences only consider input constraints, there is no need to check whether the
-         corresponding constraint has been marked for removal. */
-      relocate(constraint_reference, constraint_type); 
-    }
-  }
-  for (CRef& constraint_reference: input_constraint_references[constraint_type]) {
-    relocate(constraint_reference, constraint_type);
-  }
+  // Input constraints are never relocated, so only references to learnt constraints must be updated.
   vector<CRef>::iterator i, j;
   for (i = j = learnt_constraint_references[constraint_type].begin(); i != learnt_constraint_references[constraint_type].end(); ++i) {
     Constraint& constraint = getConstraint(*i, constraint_type);
@@ -58,40 +116,78 @@ void ConstraintDB::relocConstraintReferences(ConstraintType constraint_type) {
 }
 
 void ConstraintDB::relocAll(ConstraintType constraint_type) {
+  // Compacts the arena of learnt constraints, the arena of input constraints is left untouched.
   assert(ca_to == nullptr);
-  ConstraintAllocator to(constraints[constraint_type].size() - constraints[constraint_type].wasted(), print_trace);
+  ConstraintAllocator to(learnt_constraints[constraint_type].size() - learnt_constraints[constraint_type].wasted(), print_trace, arena_policy);
   ca_to = &to;
 
   solver.propagator->relocConstraintReferences(constraint_type);
   solver.variable_data_store->relocConstraintReferences(constraint_type);
   relocConstraintReferences(constraint_type);
 
-  to.moveTo(constraints[constraint_type]);
+  to.moveTo(learnt_constraints[constraint_type]);
   ca_to = nullptr;
 }
 
 void ConstraintDB::cleanConstraints(ConstraintType constraint_type) {
-  sort(learnt_constraint_references[constraint_type].begin(), learnt_constraint_references[constraint_type].end(), ConstraintCompare(constraints[constraint_type]));
-  uint32_t to_remove =  learnt_constraint_references[constraint_type].size() * removal_ratio[constraint_type];
+  /* Only local constraints are candidates for removal. Binary constraints are kept because the propagator processes
+     them without looking at the constraint, and locked constraints are kept because they are reasons. */
+  vector<CRef> candidates;
+  for (CRef constraint_reference: learnt_constraint_references[constraint_type]) {
+    Constraint& constraint = getConstraint(constraint_reference, constraint_type);
+    if (constraint.isMarked()) {
+      // Initial terms are marked as soon as they are added, they are removed here regardless of their tier.
+      learnt_constraints[constraint_type].free(constraint_reference & ~learnt_reference_flag);
+      nr_learnts_in_tier[constraint_type][constraint.tier]--;
+    } else if (constraint.tier == local && constraint.size > 2 && !isLocked(constraint, constraint_reference, constraint_type)) {
+      candidates.push_back(constraint_reference);
+    }
+  }
+  // Only the constraints to be removed need to be separated from the others, which does not require a full sort.
+  uint32_t to_remove = std::min(static_cast<size_t>(nr_learnts_in_tier[constraint_type][local] * removal_ratio[constraint_type]), candidates.size());
+  std::nth_element(candidates.begin(), candidates.begin() + to_remove, candidates.end(), ConstraintCompare(*this, constraint_type));
   uint32_t removed_counter = 0;
   double threshold = constraint_inc[constraint_type] / learnt_constraint_references[constraint_type].size();
-  for (CRef constraint_reference: learnt_constraint_references[constraint_type]) {
-    Constraint& constraint = constraints[constraint_type][constraint_reference];
-    if (!isLocked(constraint, constraint_reference, constraint_type) &&
-        (constraint.LBD() > LBD_threshold) &&
-        (removed_counter < to_remove || (use_activity_threshold && constraint.activity() < threshold))) {
+  for (uint32_t i = 0; i < candidates.size(); i++) {
+    Constraint& constraint = getConstraint(candidates[i], constraint_type);
+    if (i < to_remove || (use_activity_threshold && constraint.activity() < threshold)) {
       constraint.mark();
-      constraints[constraint_type].free(constraint_reference);
+      learnt_constraints[constraint_type].free(candidates[i] & ~learnt_reference_flag);
       removed_counter++;
     }
   }
+  nr_learnts_in_tier[constraint_type][local] -= removed_counter;
+  vector<CRef>::iterator i, j;
+  for (i = j = learnt_constraint_references[constraint_type].begin(); i != learnt_constraint_references[constraint_type].end(); ++i) {
+    if (!getConstraint(*i, constraint_type).isMarked()) {
+      *j++ = *i;
+    }
+  }
+  learnt_constraint_references[constraint_type].resize(j - learnt_constraint_references[constraint_type].begin(), CRef_Undef);
   LOG(info) << "Removed " << removed_counter << " learnt " << (constraint_type ? "terms": "clauses") << "." << std::endl;
-  relocAll(constraint_type);
+  checkGarbage(constraint_type);
+}
+
+void ConstraintDB::reduceTier2(ConstraintType constraint_type) {
+  // Tier-2 constraints that have not been used since the last reduction are demoted to the local tier.
+  for (CRef constraint_reference: learnt_constraint_references[constraint_type]) {
+    Constraint& constraint = getConstraint(constraint_reference, constraint_type);
+    if (constraint.tier == tier2 && !constraint.used && !constraint.isMarked()) {
+      setTier(constraint, constraint_type, local);
+    }
+    constraint.used = 0;
+  }
 }
 
 bool ConstraintDB::isLocked(Constraint& constraint, CRef constraint_reference, ConstraintType constraint_type) {
-  Variable v = var(constraint[0]);
-  return (solver.variable_data_store->isAssigned(v) && solver.variable_data_store->varType(v) == constraint_type && solver.variable_data_store->varReason(v) == constraint_reference);
+  // Binary constraints are propagated without moving the implied literal to the front, so check both literals.
+  for (uint32_t i = 0; i < constraint.size && (i == 0 || constraint.size == 2); i++) {
+    Variable v = var(constraint[i]);
+    if (solver.variable_data_store->isAssigned(v) && solver.variable_data_store->varType(v) == constraint_type && solver.variable_data_store->varReason(v) == constraint_reference) {
+      return true;
+    }
+  }
+  return false;
 }
 
 }
\ No newline at end of file
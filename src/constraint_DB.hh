@@ -3,15 +3,14 @@
 
 #include <vector>
 #include <iostream>
-#include <unordered_map>
 #include <algorithm>
 #include "solver_types.hh"
 #include "constraint.hh"
+#include "pcnf_container.hh"
 #include "qcdcl.hh"
 #include "logging.hh"
 
 using std::vector;
-using std::unordered_map;
 using std::sort;
 
 namespace Qute {
@@ -21,8 +20,10 @@ class QCDCL_solver;
 class ConstraintDB {
 
 public:
-  ConstraintDB(QCDCL_solver& solver, bool print_trace, double constraint_activity_decay, uint32_t max_learnt_clauses, uint32_t max_learnt_terms, uint32_t learnt_clauses_increment, uint32_t learnt_terms_increment, double clause_removal_ratio, double term_removal_ratio, bool use_activity_threshold, double constraint_increment, uint32_t LBD_threshold);
+  ConstraintDB(QCDCL_solver& solver, bool print_trace, double constraint_activity_decay, uint32_t max_learnt_clauses, uint32_t max_learnt_terms, uint32_t learnt_clauses_increment, uint32_t learnt_terms_increment, double clause_removal_ratio, double term_removal_ratio, bool use_activity_threshold, double constraint_increment, uint32_t LBD_threshold, uint32_t tier2_LBD_threshold, uint32_t tier2_interval, bool decreasing_LBD, ArenaPolicy arena_policy);
+  void addVariable();
   CRef addConstraint(vector<Literal>& literals, ConstraintType constraint_type, bool learnt);
+  void addConstraints(const ConstraintBatch& batch, ConstraintType constraint_type);
   Constraint& getConstraint(CRef constraint_reference, ConstraintType constraint_type);
   vector<CRef>::const_iterator constraintReferencesBegin(ConstraintType constraint_type, bool learnt);
   vector<CRef>::const_iterator constraintReferencesEnd(ConstraintType constraint_type, bool learnt);
@@ -32,34 +33,51 @@ public:
   virtual void notifyStart();
   virtual void notifyConflict(ConstraintType constraint_type);
   virtual void notifyRestart();
-  void updateLBD(Constraint& constraint);
+  void updateLBD(Constraint& constraint, ConstraintType constraint_type);
   void relocate(CRef& constraint_reference, ConstraintType constraint_type);
   
 protected:
+  /* Learnt constraints are kept in one of three tiers: core constraints (LBD at most LBD_threshold) are kept forever,
+     tier-2 constraints (LBD at most tier2_LBD_threshold) are kept as long as they are used in conflict analysis,
+     and local constraints are removed based on LBD and activity once there are too many of them. */
+  enum LearntTier { core = 0, tier2 = 1, local = 2 };
+  static constexpr double garbage_fraction = 0.2;
+  /* Input and learnt constraints are kept in separate arenas, so that garbage collection only has to compact
+     learnt constraints. References to learnt constraints are distinguished by their most significant bit. */
+  static const CRef learnt_reference_flag = CRef(1) << (sizeof(CRef) * 8 - 1);
+
   void decayConstraintActivity(ConstraintType constraint_type);
   void rescaleConstraintActivity(ConstraintType constraint_type);
   void relocConstraintReferences(ConstraintType constraint_type);
   void relocAll(ConstraintType constraint_type);
   void cleanConstraints(ConstraintType constraint_type);
+  void reduceTier2(ConstraintType constraint_type);
+  void checkGarbage(ConstraintType constraint_type);
+  LearntTier tierForLBD(uint32_t LBD) const;
+  void setTier(Constraint& constraint, ConstraintType constraint_type, LearntTier tier);
   bool isLocked(Constraint& constraint, CRef constraint_reference, ConstraintType constraint_type);
+  uint32_t computeLBD(Constraint& constraint, uint32_t bound=UINT32_MAX);
 
   struct ConstraintCompare {
-    ConstraintAllocator& ca;
-    ConstraintCompare(ConstraintAllocator& ca): ca(ca) {}
+    ConstraintDB& constraint_database;
+    ConstraintType constraint_type;
+    ConstraintCompare(ConstraintDB& constraint_database, ConstraintType constraint_type): constraint_database(constraint_database), constraint_type(constraint_type) {}
     bool operator() (CRef first_constraint_reference, CRef second_constraint_reference) {
-      return (ca[first_constraint_reference].LBD() > ca[second_constraint_reference].LBD() ||
-              (ca[first_constraint_reference].LBD() == ca[second_constraint_reference].LBD() &&
-               ca[first_constraint_reference].activity() < ca[second_constraint_reference].activity()));
+      Constraint& first = constraint_database.getConstraint(first_constraint_reference, constraint_type);
+      Constraint& second = constraint_database.getConstraint(second_constraint_reference, constraint_type);
+      return (first.LBD() > second.LBD() || (first.LBD() == second.LBD() && first.activity() < second.activity()));
     }
   };
 
   double removal_ratio[2];
   QCDCL_solver& solver;
   bool print_trace;
-  ConstraintAllocator constraints[2];
+  ArenaPolicy arena_policy;
+  ConstraintAllocator input_constraints[2];
+  ConstraintAllocator learnt_constraints[2];
   vector<CRef> input_constraint_references[2];
   vector<CRef> learnt_constraint_references[2];
-  unordered_map<Literal, vector<CRef>> literal_occurrences[2];
+  vector<vector<CRef>> literal_occurrences[2]; // Occurrences of literals in input constraints, indexed by toInt(l), built at notifyStart.
   double constraint_inc[2];
   double constraint_activity_decay;
   uint32_t learnts_max[2];
@@ -67,12 +85,31 @@ protected:
   ConstraintAllocator* ca_to;
   bool use_activity_threshold;
   uint32_t LBD_threshold;
+  uint32_t tier2_LBD_threshold;
+  uint32_t tier2_interval;
+  uint32_t conflicts_since_tier2_reduction[2];
+  uint32_t nr_learnts_in_tier[2][3];
+  bool decreasing_LBD;
+  vector<uint64_t> level_stamps; // Indexed by decision level, used by computeLBD.
+  uint64_t current_level_stamp;
 };
 
 // Implementation of inline methods.
 
+inline void ConstraintDB::addVariable() {
+  for (ConstraintType constraint_type: constraint_types) {
+    // Add entries for both literals.
+    literal_occurrences[constraint_type].emplace_back();
+    literal_occurrences[constraint_type].emplace_back();
+  }
+}
+
 inline Constraint& ConstraintDB::getConstraint(CRef constraint_reference, ConstraintType constraint_type) {
-  return constraints[constraint_type][constraint_reference];
+  if (constraint_reference & learnt_reference_flag) {
+    return learnt_constraints[constraint_type][constraint_reference & ~learnt_reference_flag];
+  } else {
+    return input_constraints[constraint_type][constraint_reference];
+  }
 }
 
 inline vector<CRef>::const_iterator ConstraintDB::constraintReferencesBegin(ConstraintType constraint_type, bool learnt) {
@@ -84,11 +121,11 @@ inline vector<CRef>::const_iterator ConstraintDB::constraintReferencesEnd(Constr
 }
 
 inline vector<CRef>::const_iterator ConstraintDB::literalOccurrencesBegin(Literal l, ConstraintType constraint_type) {
-  return literal_occurrences[constraint_type][l].cbegin();
+  return literal_occurrences[constraint_type][toInt(l)].cbegin();
 }
 
 inline vector<CRef>::const_iterator ConstraintDB::literalOccurrencesEnd(Literal l, ConstraintType constraint_type) {
-  return literal_occurrences[constraint_type][l].cend();
+  return literal_occurrences[constraint_type][toInt(l)].cend();
 }
 
 inline void ConstraintDB::bumpConstraintActivity(Constraint& constraint, ConstraintType constraint_type) {
@@ -98,12 +135,14 @@ inline void ConstraintDB::bumpConstraintActivity(Constraint& constraint, Constra
   }
 }
 
-inline void ConstraintDB::notifyStart() {}
-
 inline void ConstraintDB::notifyConflict(ConstraintType constraint_type) {
   decayConstraintActivity(constraint_type);
-  if (learnt_constraint_references[constraint_type].size() >= learnts_max[constraint_type]) {
-    LOG(info) << "Reached learnt " << (constraint_type ? "term ": "clause ") << "limit of " << learnts_max[constraint_type] << "." << std::endl;
+  if (++conflicts_since_tier2_reduction[constraint_type] >= tier2_interval) {
+    conflicts_since_tier2_reduction[constraint_type] = 0;
+    reduceTier2(constraint_type);
+  }
+  if (nr_learnts_in_tier[constraint_type][local] >= learnts_max[constraint_type]) {
+    LOG(info) << "Reached local learnt " << (constraint_type ? "term ": "clause ") << "limit of " << learnts_max[constraint_type] << "." << std::endl;
     learnts_max[constraint_type] += learnts_increment[constraint_type];
     cleanConstraints(constraint_type);
   }
@@ -112,9 +151,36 @@ inline void ConstraintDB::notifyConflict(ConstraintType constraint_type) {
 inline void ConstraintDB::notifyRestart() {
 }
 
+inline ConstraintDB::LearntTier ConstraintDB::tierForLBD(uint32_t LBD) const {
+  if (LBD <= LBD_threshold) {
+    return core;
+  } else if (LBD <= tier2_LBD_threshold) {
+    return tier2;
+  } else {
+    return local;
+  }
+}
+
+inline void ConstraintDB::setTier(Constraint& constraint, ConstraintType constraint_type, LearntTier tier) {
+  nr_learnts_in_tier[constraint_type][constraint.tier]--;
+  nr_learnts_in_tier[constraint_type][tier]++;
+  constraint.tier = tier;
+}
+
+inline void ConstraintDB::checkGarbage(ConstraintType constraint_type) {
+  // Removed constraints stay in place until enough memory is wasted to make compaction worthwhile.
+  if (learnt_constraints[constraint_type].wasted() > learnt_constraints[constraint_type].size() * garbage_fraction) {
+    relocAll(constraint_type);
+  }
+}
+
 inline void ConstraintDB::relocate(CRef& constraint_reference, ConstraintType constraint_type) {
   assert(ca_to != nullptr);
-  constraints[constraint_type].reloc(constraint_reference, *ca_to);
+  if (constraint_reference & learnt_reference_flag) {
+    CRef learnt_offset = constraint_reference & ~learnt_reference_flag;
+    learnt_constraints[constraint_type].reloc(learnt_offset, *ca_to);
+    constraint_reference = learnt_offset | learnt_reference_flag;
+  }
 }
 
 inline void ConstraintDB::decayConstraintActivity(ConstraintType constraint_type) {
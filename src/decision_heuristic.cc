@@ -6,6 +6,13 @@ DecisionHeuristic::DecisionHeuristic(QCDCL_solver& solver): solver(solver), phas
   distribution = bernoulli_distribution(0.5);
 }
 
+void DecisionHeuristic::notifyUnassignedRange(TrailIterator begin, TrailIterator end) {
+  for (TrailIterator it = end; it != begin;) {
+    --it;
+    notifyUnassigned(*it);
+  }
+}
+
 bool DecisionHeuristic::phaseHeuristic(Variable v) {
   switch (phase_heuristic)
   {
@@ -33,6 +33,7 @@ public:
   virtual void notifyStart() = 0;
   virtual void notifyAssigned(Literal l) = 0;
   virtual void notifyUnassigned(Literal l) = 0;
+  virtual void notifyUnassignedRange(TrailIterator begin, TrailIterator end);
   virtual void notifyEligible(Variable v) = 0;
   virtual void notifyLearned(Constraint& c, ConstraintType constraint_type, vector<Literal>& conflict_side_literals) = 0;
   virtual void notifyBacktrack(uint32_t decision_level_before) = 0;
@@ -46,6 +47,7 @@ public:
   bool phaseHeuristic(Variable v);
 
 protected:
+  template <class Heuristic> void notifyEachUnassigned(Heuristic& heuristic, TrailIterator begin, TrailIterator end);
   //bool svmPhase(Variable v);
   bool randomPhase();
   bool invJeroslowWang(Variable v);
@@ -71,6 +73,16 @@ inline void DecisionHeuristic::setPhaseHeuristic(PhaseHeuristicOption heuristic)
   phase_heuristic = heuristic;
 }
 
+template <class Heuristic> inline void DecisionHeuristic::notifyEachUnassigned(Heuristic& heuristic, TrailIterator begin, TrailIterator end) {
+  /* The qualified call is bound statically, so heuristics that override notifyUnassignedRange with this
+     can inline their notifyUnassigned. Literals are visited from the end of the trail, like with undoing
+     one literal at a time. */
+  for (TrailIterator it = end; it != begin;) {
+    --it;
+    heuristic.Heuristic::notifyUnassigned(*it);
+  }
+}
+
 inline bool DecisionHeuristic::randomPhase() {
   return distribution(generator);
 }
@@ -45,6 +45,10 @@ void DecisionHeuristicEMAB::notifyUnassigned(Literal l) {
   }
 }
 
+void DecisionHeuristicEMAB::notifyUnassignedRange(TrailIterator begin, TrailIterator end) {
+  notifyEachUnassigned(*this, begin, end);
+}
+
 void DecisionHeuristicEMAB::notifyEligible(Variable v) {
   if (!isAuxiliary(v)) {
     learning.updateCandidateVariable(v);
@@ -23,6 +23,10 @@ void DecisionHeuristicSGDB::notifyUnassigned(Literal l) {
   }
 }
 
+void DecisionHeuristicSGDB::notifyUnassignedRange(TrailIterator begin, TrailIterator end) {
+  notifyEachUnassigned(*this, begin, end);
+}
+
 void DecisionHeuristicSGDB::notifyLearned(Constraint& c, ConstraintType constraint_type, vector<Literal>& conflict_side_literals) {
   double activation = bias;
   updateParameters();
@@ -44,6 +44,10 @@ void DecisionHeuristicVMTFdeplearn::notifyUnassigned(Literal l) {
   }
 }
 
+void DecisionHeuristicVMTFdeplearn::notifyUnassignedRange(TrailIterator begin, TrailIterator end) {
+  notifyEachUnassigned(*this, begin, end);
+}
+
 void DecisionHeuristicVMTFdeplearn::notifyLearned(Constraint& c, ConstraintType constraint_type, vector<Literal>& conflict_side_literals) {
   // Bump every assigned variable in the learned constraint.
   for (Literal l: c) {
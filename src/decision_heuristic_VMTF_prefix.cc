@@ -58,6 +58,10 @@ void DecisionHeuristicVMTFprefix::notifyUnassigned(Literal l) {
   }
 }
 
+void DecisionHeuristicVMTFprefix::notifyUnassignedRange(TrailIterator begin, TrailIterator end) {
+  notifyEachUnassigned(*this, begin, end);
+}
+
 void DecisionHeuristicVMTFprefix::notifyLearned(Constraint& c, ConstraintType constraint_type, vector<Literal>& conflict_side_literals) {
   // Bump every assigned variable in the learned constraint.
   for (Literal l: c) {
@@ -16,6 +16,10 @@ void DecisionHeuristicVSIDSdeplearn::notifyUnassigned(Literal l) {
   }
 }
 
+void DecisionHeuristicVSIDSdeplearn::notifyUnassignedRange(TrailIterator begin, TrailIterator end) {
+  notifyEachUnassigned(*this, begin, end);
+}
+
 Literal DecisionHeuristicVSIDSdeplearn::getDecisionLiteral() {
   Variable candidate = 0;
   while (!variable_queue.empty() && !solver.dependency_manager->isDecisionCandidate(variable_queue[0])) {
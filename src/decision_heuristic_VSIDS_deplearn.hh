@@ -22,6 +22,7 @@ public:
   virtual void notifyStart();
   virtual void notifyAssigned(Literal l);
   virtual void notifyUnassigned(Literal l);
+  virtual void notifyUnassignedRange(TrailIterator begin, TrailIterator end);
   virtual void notifyEligible(Variable v);
   virtual void notifyLearned(Constraint& c, ConstraintType constraint_type, vector<Literal>& conflict_side_literals);
   virtual void notifyBacktrack(uint32_t decision_level_before);
@@ -48,6 +48,10 @@ void DecisionHeuristicSplitVMTF::notifyUnassigned(Literal l) {
   }
 }
 
+void DecisionHeuristicSplitVMTF::notifyUnassignedRange(TrailIterator begin, TrailIterator end) {
+  notifyEachUnassigned(*this, begin, end);
+}
+
 void DecisionHeuristicSplitVMTF::notifyLearned(Constraint& c, ConstraintType constraint_type, vector<Literal>& conflict_side_literals) {
   // Bump every assigned variable in the learned constraint, if the constraint fits the current mode.
   if (always_move) {
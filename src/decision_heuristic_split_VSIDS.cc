@@ -55,6 +55,10 @@ void DecisionHeuristicSplitVSIDS::notifyUnassigned(Literal l) {
   }
 }
 
+void DecisionHeuristicSplitVSIDS::notifyUnassignedRange(TrailIterator begin, TrailIterator end) {
+  notifyEachUnassigned(*this, begin, end);
+}
+
 void DecisionHeuristicSplitVSIDS::notifyLearned(Constraint& c, ConstraintType constraint_type,
     vector<Literal>& conflict_side_literals) {
 
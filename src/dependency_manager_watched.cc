@@ -3,7 +3,7 @@
 
 namespace Qute {
 
-DependencyManagerWatched::DependencyManagerWatched(QCDCL_solver& solver, string dependency_learning_strategy): learnDependenciesPtr(nullptr), solver(solver), prefix_mode(false) {
+DependencyManagerWatched::DependencyManagerWatched(QCDCL_solver& solver, string dependency_learning_strategy, string dependency_set_representation): learnDependenciesPtr(nullptr), solver(solver), prefix_mode(false), bitset_mode(dependency_set_representation == "bitset"), nr_variables_of_type{0, 0} {
   if (dependency_learning_strategy == "off") {
     prefix_mode = true;
   } else if (dependency_learning_strategy == "all") {
@@ -15,6 +15,15 @@ DependencyManagerWatched::DependencyManagerWatched(QCDCL_solver& solver, string
   }
 }
 
+void DependencyManagerWatched::addVariable(bool auxiliary) {
+  variables_watched_by.emplace_back();
+  variable_dependencies.emplace_back();
+  is_auxiliary.push_back(auxiliary);
+  // The variable has already been added to the variable data store.
+  bool variable_type = solver.variable_data_store->varType(variable_dependencies.size());
+  quantifier_rank.push_back(nr_variables_of_type[variable_type]++);
+}
+
 void DependencyManagerWatched::learnAllDependencies(Variable unit_variable, vector<Literal>& literal_vector) {
   for (Literal l : literal_vector) {
     addDependency(unit_variable, var(l));
@@ -39,7 +48,7 @@ void DependencyManagerWatched::learnDependencyWithFewestDependencies(Variable un
   Variable variable_with_fewest_deps = 0;
   for (Literal l : literal_vector) {
     Variable current_var = var(l);
-    uint32_t current_deps = variable_dependencies[current_var - 1].dependent_on.size();
+    uint32_t current_deps = variable_dependencies[current_var - 1].dependent_on_vector.size();
     if (current_deps < fewest_deps) {
        variable_with_fewest_deps = current_var;
        fewest_deps = current_deps;
@@ -77,7 +86,24 @@ void DependencyManagerWatched::addDependency(Variable of, Variable on) {
   if (!dependsOn(of, on)) {
     LOG(trace) << "Dependency added: (" << of << ", " << on << ")" << std::endl;
     solver.solver_statistics.nr_dependencies++;
-    variable_dependencies[of - 1].dependent_on.insert(on);
+    if (bitset_mode) {
+      assert(solver.variable_data_store->varType(of) != solver.variable_data_store->varType(on));
+      DependencyData& data = variable_dependencies[of - 1];
+      uint32_t rank = quantifier_rank[on - 1];
+      uint32_t word = rank >> 6;
+      if (data.dependent_on_bits.empty()) {
+        data.first_word = word;
+      } else if (word < data.first_word) {
+        data.dependent_on_bits.insert(data.dependent_on_bits.begin(), data.first_word - word, 0);
+        data.first_word = word;
+      }
+      if (word - data.first_word >= data.dependent_on_bits.size()) {
+        data.dependent_on_bits.resize(word - data.first_word + 1, 0);
+      }
+      data.dependent_on_bits[word - data.first_word] |= uint64_t(1) << (rank & 63);
+    } else {
+      variable_dependencies[of - 1].dependent_on.insert(on);
+    }
     variable_dependencies[of - 1].dependent_on_vector.push_back(on);
     /* If the current watched dependency is 0 or a variable that is assigned,
        make the newly added dependency the new watched dependency. */
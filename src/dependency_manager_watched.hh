@@ -24,7 +24,7 @@ friend class DecisionHeuristicSGDB;
 friend class DecisionHeuristicEMAB;
 
 public:
-  DependencyManagerWatched(QCDCL_solver& solver, string dependency_learning_strategy);
+  DependencyManagerWatched(QCDCL_solver& solver, string dependency_learning_strategy, string dependency_set_representation);
   virtual void addVariable(bool auxiliary);
   virtual void addDependency(Variable of, Variable on);
   virtual void notifyStart();
@@ -48,8 +48,14 @@ protected:
     Variable watcher;
     uint32_t watcher_index;
     unordered_set<Variable> dependent_on;
+    /* Used instead of "dependent_on" in bitset mode. Dependencies are always on variables of the opposite quantifier type,
+       so they are indexed by their quantifier rank (see quantifier_rank), and only the words from the lowest to the
+       highest dependency are stored: bit i of word w is set iff the variable depends on the rank 64 * (first_word + w) + i.
+       A rank does not identify a variable of the same type, so dependsOn must only be asked about the opposite type. */
+    vector<uint64_t> dependent_on_bits;
+    uint32_t first_word;
     vector<Variable> dependent_on_vector;
-    DependencyData(): watcher(0) {};
+    DependencyData(): watcher(0), first_word(0) {};
   };
 
   vector<DependencyData> variable_dependencies;
@@ -57,18 +63,15 @@ protected:
 
   QCDCL_solver& solver;
   bool prefix_mode;
+  bool bitset_mode;
   vector<bool> is_auxiliary;
+  vector<uint32_t> quantifier_rank; // Position of each variable among the variables of its quantifier type.
+  uint32_t nr_variables_of_type[2];
 
 };
 
 // Implementation of inline methods.
 
-inline void DependencyManagerWatched::addVariable(bool auxiliary) {
-  variables_watched_by.emplace_back();
-  variable_dependencies.emplace_back();
-  is_auxiliary.push_back(auxiliary);
-}
-
 inline void DependencyManagerWatched::notifyStart() {}
 
 inline void DependencyManagerWatched::notifyUnassigned(Variable v) {}
@@ -76,6 +79,11 @@ inline void DependencyManagerWatched::notifyUnassigned(Variable v) {}
 inline bool DependencyManagerWatched::dependsOn(Variable of, Variable on) const {
   if (prefix_mode) {
     return on < of;
+  } else if (bitset_mode) {
+    const DependencyData& data = variable_dependencies[of - 1];
+    uint32_t rank = quantifier_rank[on - 1];
+    uint32_t word = (rank >> 6) - data.first_word; // Wraps around for ranks below the first stored word.
+    return word < data.dependent_on_bits.size() && ((data.dependent_on_bits[word] >> (rank & 63)) & 1);
   } else {
     return variable_dependencies[of - 1].dependent_on.find(on) != variable_dependencies[of - 1].dependent_on.end();
   }
@@ -0,0 +1,195 @@
+#include "formula_cache.hh"
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using std::cerr;
+using std::endl;
+
+namespace Qute {
+
+const char FormulaCache::magic[8] = {'Q', 'U', 'T', 'E', 'F', 'C', '\r', '\n'};
+
+static void formulaCacheError(const string& filename, const string& message) {
+  cerr << "Error: " << message << " (formula cache '" << filename << "')." << endl;
+  exit(1);
+}
+
+static uint64_t paddedSize(uint64_t bytes) {
+  return (bytes + 7) & ~uint64_t(7);
+}
+
+static void writeSection(std::ofstream& file, const void* data, uint64_t bytes) {
+  static const char zeros[8] = {0};
+  file.write(static_cast<const char*>(data), bytes);
+  file.write(zeros, paddedSize(bytes) - bytes);
+}
+
+/* Returns the section of count elements of the given size at position and advances position past it, or nullptr
+   if the image is too short. The count is checked before it is multiplied, so that a corrupt count cannot wrap. */
+static const char* readSection(const char*& position, const char* end, uint64_t count, size_t element_size) {
+  uint64_t available = end - position;
+  if (count > available / element_size || paddedSize(count * element_size) > available) {
+    return nullptr;
+  }
+  const char* section = position;
+  position += paddedSize(count * element_size);
+  return section;
+}
+
+FormulaCache::FormulaCache(PCNFContainer& target): target(target), name_offsets(1, 0) {}
+
+void FormulaCache::addVariable(string original_name, char variable_type, bool auxiliary) {
+  variable_types.push_back(variable_type);
+  variable_auxiliary.push_back(auxiliary);
+  names += original_name;
+  name_offsets.push_back(names.size());
+  target.addVariable(original_name, variable_type, auxiliary);
+}
+
+void FormulaCache::addConstraint(vector<Literal>& literals, ConstraintType constraint_type) {
+  // The target normalizes the literals in place, so that the image holds them as they are stored.
+  target.addConstraint(literals, constraint_type);
+  constraints[constraint_type].add(literals);
+}
+
+void FormulaCache::addDependency(Variable of, Variable on) {
+  dependencies.push_back(of);
+  dependencies.push_back(on);
+  target.addDependency(of, on);
+}
+
+void FormulaCache::addConstraints(ConstraintBatch& batch, ConstraintType constraint_type) {
+  target.addConstraints(batch, constraint_type);
+  for (uint32_t i = 0; i < batch.size(); i++) {
+    ConstraintBatch& recorded = constraints[constraint_type];
+    recorded.literals.insert(recorded.literals.end(), batch.constraintBegin(i), batch.constraintBegin(i) + batch.constraintSize(i));
+    recorded.offsets.push_back(recorded.literals.size());
+  }
+}
+
+bool FormulaCache::write(const string& filename, bool use_model_generation) const {
+  std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    return false;
+  }
+  Header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, magic, sizeof(magic));
+  header.version = version;
+  header.use_model_generation = use_model_generation;
+  header.nr_variables = variable_types.size();
+  header.names_size = names.size();
+  header.nr_dependencies = dependencies.size() / 2;
+  for (ConstraintType constraint_type: constraint_types) {
+    header.nr_constraints[constraint_type] = constraints[constraint_type].size();
+    header.nr_literals[constraint_type] = constraints[constraint_type].literals.size();
+  }
+  writeSection(file, &header, sizeof(header));
+  writeSection(file, variable_types.data(), variable_types.size());
+  writeSection(file, variable_auxiliary.data(), variable_auxiliary.size());
+  writeSection(file, name_offsets.data(), name_offsets.size() * sizeof(uint64_t));
+  writeSection(file, names.data(), names.size());
+  writeSection(file, dependencies.data(), dependencies.size() * sizeof(Variable));
+  for (ConstraintType constraint_type: constraint_types) {
+    vector<uint64_t> offsets(constraints[constraint_type].offsets.begin(), constraints[constraint_type].offsets.end());
+    writeSection(file, offsets.data(), offsets.size() * sizeof(uint64_t));
+    writeSection(file, constraints[constraint_type].literals.data(), constraints[constraint_type].literals.size() * sizeof(Literal));
+  }
+  return file.good();
+}
+
+bool FormulaCache::isCacheFile(const string& filename) {
+  char file_magic[sizeof(magic)];
+  std::ifstream file(filename, std::ios::binary);
+  return file.read(file_magic, sizeof(file_magic)) && memcmp(file_magic, magic, sizeof(magic)) == 0;
+}
+
+uint64_t FormulaCache::load(const string& filename, PCNFContainer& target, bool use_model_generation) {
+  int file_descriptor = open(filename.c_str(), O_RDONLY);
+  struct stat file_status;
+  if (file_descriptor < 0 || fstat(file_descriptor, &file_status) != 0) {
+    formulaCacheError(filename, "Cannot open the file");
+  }
+  uint64_t file_size = file_status.st_size;
+  void* mapping = file_size > 0 ? mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0) : MAP_FAILED;
+  close(file_descriptor);
+  if (mapping == MAP_FAILED) {
+    formulaCacheError(filename, "Cannot map the file");
+  }
+  madvise(mapping, file_size, MADV_SEQUENTIAL);
+  const char* position = static_cast<const char*>(mapping);
+  const char* end = position + file_size;
+
+  const Header* header = reinterpret_cast<const Header*>(readSection(position, end, 1, sizeof(Header)));
+  if (header == nullptr || memcmp(header->magic, magic, sizeof(magic)) != 0) {
+    formulaCacheError(filename, "Not a formula cache");
+  }
+  if (header->version != version) {
+    formulaCacheError(filename, "Unsupported version " + std::to_string(header->version) + ", expected " + std::to_string(version));
+  }
+  if (static_cast<bool>(header->use_model_generation) != use_model_generation) {
+    formulaCacheError(filename, "Written with a different --model-generation setting, which changes the formula");
+  }
+  uint32_t nr_variables = header->nr_variables;
+  const char* types = readSection(position, end, nr_variables, sizeof(char));
+  const char* auxiliary = readSection(position, end, nr_variables, sizeof(char));
+  const uint64_t* offsets = reinterpret_cast<const uint64_t*>(readSection(position, end, nr_variables + uint64_t(1), sizeof(uint64_t)));
+  const char* names = readSection(position, end, header->names_size, sizeof(char));
+  const Variable* dependencies = reinterpret_cast<const Variable*>(readSection(position, end, header->nr_dependencies, 2 * sizeof(Variable)));
+  if (types == nullptr || auxiliary == nullptr || offsets == nullptr || names == nullptr || dependencies == nullptr) {
+    formulaCacheError(filename, "Truncated file");
+  }
+
+  for (Variable v = 0; v < static_cast<Variable>(nr_variables); v++) {
+    if (offsets[v] > offsets[v + 1] || offsets[v + 1] > header->names_size) {
+      formulaCacheError(filename, "Corrupt variable names");
+    }
+    if (types[v] != 'a' && types[v] != 'e') {
+      formulaCacheError(filename, "Corrupt variable types");
+    }
+    target.addVariable(string(names + offsets[v], offsets[v + 1] - offsets[v]), types[v], auxiliary[v]);
+  }
+  for (uint64_t i = 0; i < header->nr_dependencies; i++) {
+    Variable of = dependencies[2 * i];
+    Variable on = dependencies[2 * i + 1];
+    if (of < 1 || on < 1 || of > static_cast<Variable>(nr_variables) || on > static_cast<Variable>(nr_variables)) {
+      formulaCacheError(filename, "Corrupt dependencies");
+    }
+    target.addDependency(of, on);
+  }
+  for (ConstraintType constraint_type: constraint_types) {
+    uint32_t nr_constraints = header->nr_constraints[constraint_type];
+    uint64_t nr_literals = header->nr_literals[constraint_type];
+    const uint64_t* constraint_offsets = reinterpret_cast<const uint64_t*>(readSection(position, end, nr_constraints + uint64_t(1), sizeof(uint64_t)));
+    const Literal* literals = reinterpret_cast<const Literal*>(readSection(position, end, nr_literals, sizeof(Literal)));
+    if (constraint_offsets == nullptr || literals == nullptr) {
+      formulaCacheError(filename, "Truncated file");
+    }
+    if (constraint_offsets[0] != 0 || constraint_offsets[nr_constraints] != nr_literals) {
+      formulaCacheError(filename, "Corrupt constraint offsets");
+    }
+    ConstraintBatch batch;
+    batch.offsets.assign(constraint_offsets, constraint_offsets + nr_constraints + 1);
+    batch.literals.assign(literals, literals + nr_literals);
+    for (uint32_t i = 0; i < nr_constraints; i++) {
+      if (batch.offsets[i] > batch.offsets[i + 1]) {
+        formulaCacheError(filename, "Corrupt constraint offsets");
+      }
+    }
+    for (Literal l: batch.literals) {
+      if (toInt(l) < Min_Literal_Int || var(l) > static_cast<Variable>(nr_variables)) {
+        formulaCacheError(filename, "Corrupt constraint literals");
+      }
+    }
+    target.addConstraints(batch, constraint_type);
+  }
+  munmap(mapping, file_size);
+  return file_size;
+}
+
+}
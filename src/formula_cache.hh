@@ -0,0 +1,64 @@
+#ifndef formula_cache_hh
+#define formula_cache_hh
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "pcnf_container.hh"
+#include "solver_types.hh"
+
+using std::string;
+using std::vector;
+
+namespace Qute {
+
+/* A binary image of a parsed formula, so that repeated runs on the same instance do not have to parse it again.
+   While parsing, the cache records the formula that is passed on to another container, and can then write it
+   to a file. Loading maps such a file and adds the formula to a container in bulk, with its constraints already
+   sorted and deduplicated. Integers are stored in native byte order, so an image is only portable between
+   machines of the same endianness. */
+class FormulaCache: public PCNFContainer {
+
+public:
+  FormulaCache(PCNFContainer& target);
+  virtual void addVariable(string original_name, char variable_type, bool auxiliary);
+  virtual void addConstraint(vector<Literal>& literals, ConstraintType constraint_type);
+  virtual void addDependency(Variable of, Variable on);
+  virtual void addConstraints(ConstraintBatch& batch, ConstraintType constraint_type);
+
+  bool write(const string& filename, bool use_model_generation) const;
+  static bool isCacheFile(const string& filename);
+  static uint64_t load(const string& filename, PCNFContainer& target, bool use_model_generation);
+
+protected:
+  // Increased whenever the layout of the image changes, images of other versions are rejected.
+  static const uint32_t version = 1;
+  static const char magic[8];
+
+  /* The image starts with this header, followed by the variable types, the auxiliary flags, the name offsets,
+     the names, the dependencies, and the offsets and literals of the clauses and of the terms. Each of these
+     sections starts at a multiple of 8 bytes. */
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t use_model_generation; // The Tseitin terms of a QDIMACS formula are only added without model generation.
+    uint32_t nr_variables;
+    uint32_t nr_constraints[2];
+    uint32_t padding;
+    uint64_t names_size;
+    uint64_t nr_dependencies;
+    uint64_t nr_literals[2];
+  };
+
+  PCNFContainer& target;
+  vector<char> variable_types;
+  vector<char> variable_auxiliary;
+  vector<uint64_t> name_offsets;
+  string names;
+  vector<Variable> dependencies; // Pairs (of, on) in the order in which they were added.
+  ConstraintBatch constraints[2]; // Indexed by ConstraintType.
+};
+
+}
+
+#endif
@@ -0,0 +1,365 @@
+#include "input_buffer.hh"
+#include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_LZMA
+#include <lzma.h>
+#endif
+#ifdef HAVE_BZIP2
+#include <bzlib.h>
+#endif
+
+using std::cerr;
+using std::endl;
+
+namespace Qute {
+
+static const char* compressionName(InputBuffer::Compression compression) {
+  switch (compression) {
+    case InputBuffer::Compression::gzip:
+      return "gzip";
+    case InputBuffer::Compression::xz:
+      return "xz";
+    case InputBuffer::Compression::bzip2:
+      return "bzip2";
+    default:
+      return "none";
+  }
+}
+
+static void compressedInputError(InputBuffer::Compression compression, const string& message) {
+  cerr << "Error: " << message << " (" << compressionName(compression) << " input)." << endl;
+  exit(1);
+}
+
+InputBuffer::InputBuffer(std::istream& stream): buffer_begin(nullptr), position(nullptr), end(nullptr), bytes_before_buffer(0), stream(&stream), file_descriptor(-1), mapping(nullptr), mapping_size(0), first_chunk(true), compression(Compression::none), decoder(nullptr), raw_position(nullptr), raw_end(nullptr) {}
+
+InputBuffer::InputBuffer(const string& filename): buffer_begin(nullptr), position(nullptr), end(nullptr), bytes_before_buffer(0), stream(nullptr), file_descriptor(-1), mapping(nullptr), mapping_size(0), first_chunk(true), compression(Compression::none), decoder(nullptr), raw_position(nullptr), raw_end(nullptr) {
+  file_descriptor = open(filename.c_str(), O_RDONLY);
+  if (file_descriptor < 0) {
+    return;
+  }
+  struct stat file_status;
+  if (fstat(file_descriptor, &file_status) == 0 && S_ISREG(file_status.st_mode) && file_status.st_size > 0) {
+    void* mapped = mmap(nullptr, file_status.st_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+    if (mapped != MAP_FAILED) {
+      madvise(mapped, file_status.st_size, MADV_SEQUENTIAL);
+      mapping = mapped;
+      mapping_size = file_status.st_size;
+      first_chunk = false;
+      detectCompression(static_cast<const char*>(mapping), mapping_size);
+      if (compression == Compression::none) {
+        buffer_begin = position = static_cast<const char*>(mapping);
+        end = position + mapping_size;
+      } else {
+        // The mapped file is the compressed input, the decompressed contents are produced on demand.
+        raw_position = static_cast<const char*>(mapping);
+        raw_end = raw_position + mapping_size;
+        startDecoder();
+      }
+    }
+  }
+  // If the file cannot be mapped (for instance because it is a pipe), it is read in chunks.
+}
+
+InputBuffer::~InputBuffer() {
+  endDecoder();
+  if (mapping != nullptr) {
+    munmap(mapping, mapping_size);
+  }
+  if (file_descriptor >= 0) {
+    close(file_descriptor);
+  }
+}
+
+bool InputBuffer::isStandardInput() const {
+  return stream == &std::cin;
+}
+
+bool InputBuffer::readLine(string& line) {
+  if (peek() == End) {
+    return false;
+  }
+  line.clear();
+  int c;
+  while ((c = peek()) != End) {
+    position++;
+    if (c == '\n') {
+      break;
+    }
+    line.push_back(static_cast<char>(c));
+  }
+  return true;
+}
+
+void InputBuffer::remainingInput(const char*& begin, const char*& end, string& storage) {
+  // The rest of a mapped file is returned in place, any other input is collected in storage.
+  if (mapping != nullptr && compression == Compression::none) {
+    begin = position;
+    end = this->end;
+    position = this->end;
+    return;
+  }
+  storage.clear();
+  while (peek() != End) {
+    storage.append(position, this->end);
+    position = this->end;
+  }
+  begin = storage.data();
+  end = begin + storage.size();
+}
+
+void InputBuffer::integerOutOfRangeError() {
+  cerr << "Error: Integer out of range at byte " << bytesConsumed() << "." << endl;
+  exit(1);
+}
+
+bool InputBuffer::refill() {
+  bytes_before_buffer += end - buffer_begin;
+  buffer_begin = position = end;
+  if (compression != Compression::none) {
+    return decompress();
+  }
+  // A mapped file is consumed once the end of the mapping is reached.
+  if (mapping != nullptr) {
+    return false;
+  }
+  if (chunk.empty()) {
+    chunk.resize(chunk_size);
+  }
+  size_t bytes_read = readRaw(chunk.data(), chunk.size());
+  if (first_chunk) {
+    first_chunk = false;
+    detectCompression(chunk.data(), bytes_read);
+    if (compression != Compression::none) {
+      // The chunk that has just been read is the beginning of the compressed input.
+      raw_chunk.swap(chunk);
+      raw_position = raw_chunk.data();
+      raw_end = raw_position + bytes_read;
+      startDecoder();
+      return decompress();
+    }
+  }
+  buffer_begin = position = chunk.data();
+  end = position + bytes_read;
+  return bytes_read > 0;
+}
+
+size_t InputBuffer::readRaw(char* buffer, size_t capacity) {
+  if (stream != nullptr) {
+    stream->read(buffer, capacity);
+    return stream->gcount();
+  } else if (file_descriptor >= 0) {
+    ssize_t bytes_read;
+    do {
+      bytes_read = read(file_descriptor, buffer, capacity);
+    } while (bytes_read < 0 && errno == EINTR);
+    return bytes_read > 0 ? bytes_read : 0;
+  } else {
+    return 0;
+  }
+}
+
+void InputBuffer::detectCompression(const char* data, size_t size) {
+  static const unsigned char gzip_magic[] = {0x1f, 0x8b};
+  static const unsigned char xz_magic[] = {0xfd, '7', 'z', 'X', 'Z', 0x00};
+  static const unsigned char bzip2_magic[] = {'B', 'Z', 'h'};
+  if (size >= sizeof(gzip_magic) && memcmp(data, gzip_magic, sizeof(gzip_magic)) == 0) {
+    compression = Compression::gzip;
+  } else if (size >= sizeof(xz_magic) && memcmp(data, xz_magic, sizeof(xz_magic)) == 0) {
+    compression = Compression::xz;
+  } else if (size >= sizeof(bzip2_magic) && memcmp(data, bzip2_magic, sizeof(bzip2_magic)) == 0) {
+    compression = Compression::bzip2;
+  } else {
+    compression = Compression::none;
+  }
+}
+
+bool InputBuffer::decompress() {
+  if (chunk.empty()) {
+    chunk.resize(chunk_size);
+  }
+  size_t produced = 0;
+  while (produced == 0 && decoder != nullptr) {
+    bool input_finished = false;
+    if (raw_position == raw_end) {
+      if (mapping == nullptr) {
+        size_t bytes_read = readRaw(raw_chunk.data(), raw_chunk.size());
+        raw_position = raw_chunk.data();
+        raw_end = raw_position + bytes_read;
+      }
+      input_finished = (raw_position == raw_end);
+    }
+    bool stream_end = false;
+    produced = decodeStep(chunk.data(), chunk.size(), input_finished, stream_end);
+    if (stream_end) {
+      // Another compressed stream may follow, as with concatenated gzip files.
+      endDecoder();
+      if (raw_position == raw_end && mapping == nullptr) {
+        size_t bytes_read = readRaw(raw_chunk.data(), raw_chunk.size());
+        raw_position = raw_chunk.data();
+        raw_end = raw_position + bytes_read;
+      }
+      if (raw_position != raw_end) {
+        startDecoder();
+      }
+    } else if (input_finished && produced == 0) {
+      compressedInputError(compression, "Unexpected end of compressed input");
+    }
+  }
+  buffer_begin = position = chunk.data();
+  end = position + produced;
+  return produced > 0;
+}
+
+void InputBuffer::startDecoder() {
+  switch (compression) {
+    case Compression::gzip: {
+#ifdef HAVE_ZLIB
+      z_stream* zs = new z_stream();
+      // Window size 15 with 32 added accepts both gzip and zlib headers.
+      if (inflateInit2(zs, 15 + 32) != Z_OK) {
+        delete zs;
+        compressedInputError(compression, "Cannot initialize decompression");
+      }
+      decoder = zs;
+      return;
+#else
+      break;
+#endif
+    }
+    case Compression::xz: {
+#ifdef HAVE_LZMA
+      lzma_stream* ls = new lzma_stream;
+      lzma_stream initial = LZMA_STREAM_INIT;
+      *ls = initial;
+      if (lzma_stream_decoder(ls, UINT64_MAX, LZMA_CONCATENATED) != LZMA_OK) {
+        delete ls;
+        compressedInputError(compression, "Cannot initialize decompression");
+      }
+      decoder = ls;
+      return;
+#else
+      break;
+#endif
+    }
+    case Compression::bzip2: {
+#ifdef HAVE_BZIP2
+      bz_stream* bs = new bz_stream();
+      if (BZ2_bzDecompressInit(bs, 0, 0) != BZ_OK) {
+        delete bs;
+        compressedInputError(compression, "Cannot initialize decompression");
+      }
+      decoder = bs;
+      return;
+#else
+      break;
+#endif
+    }
+    default:
+      return;
+  }
+  compressedInputError(compression, "Qute was built without support for this compression format");
+}
+
+void InputBuffer::endDecoder() {
+  if (decoder == nullptr) {
+    return;
+  }
+  switch (compression) {
+#ifdef HAVE_ZLIB
+    case Compression::gzip:
+      inflateEnd(static_cast<z_stream*>(decoder));
+      delete static_cast<z_stream*>(decoder);
+      break;
+#endif
+#ifdef HAVE_LZMA
+    case Compression::xz:
+      lzma_end(static_cast<lzma_stream*>(decoder));
+      delete static_cast<lzma_stream*>(decoder);
+      break;
+#endif
+#ifdef HAVE_BZIP2
+    case Compression::bzip2:
+      BZ2_bzDecompressEnd(static_cast<bz_stream*>(decoder));
+      delete static_cast<bz_stream*>(decoder);
+      break;
+#endif
+    default:
+      break;
+  }
+  decoder = nullptr;
+}
+
+size_t InputBuffer::decodeStep(char* output, size_t capacity, bool input_finished, bool& stream_end) {
+  // Decompresses from raw_position into output, and advances raw_position past the consumed input.
+  size_t produced = 0;
+  switch (compression) {
+#ifdef HAVE_ZLIB
+    case Compression::gzip: {
+      z_stream* zs = static_cast<z_stream*>(decoder);
+      size_t available = raw_end - raw_position;
+      zs->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(raw_position));
+      zs->avail_in = available;
+      zs->next_out = reinterpret_cast<Bytef*>(output);
+      zs->avail_out = capacity;
+      int result = inflate(zs, Z_NO_FLUSH);
+      if (result != Z_OK && result != Z_STREAM_END && !(result == Z_BUF_ERROR && !input_finished)) {
+        compressedInputError(compression, "Corrupt compressed input");
+      }
+      stream_end = (result == Z_STREAM_END);
+      raw_position += available - zs->avail_in;
+      produced = capacity - zs->avail_out;
+      break;
+    }
+#endif
+#ifdef HAVE_LZMA
+    case Compression::xz: {
+      lzma_stream* ls = static_cast<lzma_stream*>(decoder);
+      size_t available = raw_end - raw_position;
+      ls->next_in = reinterpret_cast<const uint8_t*>(raw_position);
+      ls->avail_in = available;
+      ls->next_out = reinterpret_cast<uint8_t*>(output);
+      ls->avail_out = capacity;
+      lzma_ret result = lzma_code(ls, input_finished ? LZMA_FINISH : LZMA_RUN);
+      if (result != LZMA_OK && result != LZMA_STREAM_END && !(result == LZMA_BUF_ERROR && !input_finished)) {
+        compressedInputError(compression, "Corrupt compressed input");
+      }
+      stream_end = (result == LZMA_STREAM_END);
+      raw_position += available - ls->avail_in;
+      produced = capacity - ls->avail_out;
+      break;
+    }
+#endif
+#ifdef HAVE_BZIP2
+    case Compression::bzip2: {
+      bz_stream* bs = static_cast<bz_stream*>(decoder);
+      size_t available = raw_end - raw_position;
+      bs->next_in = const_cast<char*>(raw_position);
+      bs->avail_in = available;
+      bs->next_out = output;
+      bs->avail_out = capacity;
+      int result = BZ2_bzDecompress(bs);
+      if (result != BZ_OK && result != BZ_STREAM_END) {
+        compressedInputError(compression, "Corrupt compressed input");
+      }
+      stream_end = (result == BZ_STREAM_END);
+      raw_position += available - bs->avail_in;
+      produced = capacity - bs->avail_out;
+      break;
+    }
+#endif
+    default:
+      break;
+  }
+  return produced;
+}
+
+}
@@ -0,0 +1,142 @@
+#ifndef input_buffer_hh
+#define input_buffer_hh
+
+#include <istream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+using std::string;
+using std::vector;
+
+namespace Qute {
+
+/* Buffered input for the parser. A regular file is mapped into memory as a whole,
+   other inputs (such as the standard input or pipes) are read in large chunks.
+   The scanning methods only refill the buffer once it is exhausted.
+   Input compressed with gzip, xz or bzip2 is recognized by its magic bytes and
+   decompressed chunk by chunk while it is scanned. */
+class InputBuffer {
+
+public:
+  static const int End = -1;
+
+  enum class Compression { none, gzip, xz, bzip2 };
+
+  InputBuffer(std::istream& stream);
+  InputBuffer(const string& filename);
+  ~InputBuffer();
+  InputBuffer(const InputBuffer&) = delete;
+  InputBuffer& operator=(const InputBuffer&) = delete;
+
+  bool isOpen() const;
+  bool isStandardInput() const;
+  uint64_t bytesConsumed() const;
+
+  int peek();
+  void advance();
+  void skipWhitespace();
+  void skipLine();
+  bool readInt(int32_t& value);
+  bool readLine(string& line);
+  void remainingInput(const char*& begin, const char*& end, string& storage);
+
+protected:
+  bool refill();
+  void integerOutOfRangeError();
+  size_t readRaw(char* buffer, size_t capacity);
+  void detectCompression(const char* data, size_t size);
+  bool decompress();
+  size_t decodeStep(char* output, size_t capacity, bool input_finished, bool& stream_end);
+  void startDecoder();
+  void endDecoder();
+
+  static const size_t chunk_size = 1 << 20;
+
+  const char* buffer_begin;
+  const char* position;
+  const char* end;
+  uint64_t bytes_before_buffer; // Number of bytes consumed before the current buffer contents.
+  std::istream* stream;
+  int file_descriptor;
+  void* mapping;
+  size_t mapping_size;
+  vector<char> chunk;
+  bool first_chunk;
+
+  // Compressed input is read into raw_chunk (unless the file is mapped) and decompressed into chunk.
+  Compression compression;
+  void* decoder;
+  const char* raw_position;
+  const char* raw_end;
+  vector<char> raw_chunk;
+
+};
+
+// Implementation of inline methods.
+
+inline bool InputBuffer::isOpen() const {
+  return stream != nullptr || file_descriptor >= 0;
+}
+
+inline uint64_t InputBuffer::bytesConsumed() const {
+  return bytes_before_buffer + (position - buffer_begin);
+}
+
+inline int InputBuffer::peek() {
+  if (position == end && !refill()) {
+    return End;
+  }
+  return static_cast<unsigned char>(*position);
+}
+
+inline void InputBuffer::advance() {
+  if (position != end || refill()) {
+    position++;
+  }
+}
+
+inline void InputBuffer::skipWhitespace() {
+  int c;
+  while ((c = peek()) == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f') {
+    position++;
+  }
+}
+
+inline void InputBuffer::skipLine() {
+  int c;
+  while ((c = peek()) != End) {
+    position++;
+    if (c == '\n') {
+      break;
+    }
+  }
+}
+
+inline bool InputBuffer::readInt(int32_t& value) {
+  // Reads an optionally signed decimal integer after skipping whitespace.
+  skipWhitespace();
+  bool negative = (peek() == '-');
+  if (negative) {
+    position++;
+  }
+  int c = peek();
+  if (c < '0' || c > '9') {
+    return false;
+  }
+  uint32_t magnitude = 0;
+  do {
+    uint32_t digit = c - '0';
+    if (magnitude > (static_cast<uint32_t>(INT32_MAX) - digit) / 10) {
+      integerOutOfRangeError();
+    }
+    magnitude = magnitude * 10 + digit;
+    position++;
+  } while ((c = peek()) >= '0' && c <= '9');
+  value = negative ? -static_cast<int32_t>(magnitude) : static_cast<int32_t>(magnitude);
+  return true;
+}
+
+}
+
+#endif
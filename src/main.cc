@@ -3,11 +3,14 @@
 #include <csignal>
 #include <iostream>
 #include <string>
+#include <chrono>
 
 #include "main.hh"
 #include "logging.hh"
 #include "qcdcl.hh"
 #include "parser.hh"
+#include "input_buffer.hh"
+#include "formula_cache.hh"
 #include "solver_types.hh"
 #include "constraint_DB.hh"
 #include "decision_heuristic_VMTF_deplearn.hh"
@@ -31,7 +34,6 @@ using namespace Qute;
 using namespace std::placeholders;
 using std::cerr;
 using std::cout;
-using std::ifstream;
 using std::to_string;
 using std::string;
 
@@ -54,6 +56,9 @@ General Options:
   --term-removal-ratio <double>         fraction of terms removed while cleaning [default: 0.5]
   --use-activity-threshold              remove all constraints with activities below threshold
   --LBD-threshold <int>                 only remove constraints with LBD larger than this [default: 2]
+  --tier2-LBD-threshold <int>           keep constraints with LBD at most this while they are used [default: 6]
+  --tier2-interval <int>                conflicts between demotions of unused tier-2 constraints [default: 10000]
+  --decreasing-LBD                      only update the LBD of a learnt constraint if it decreases
   --constraint-activity-inc <double>    constraint activity increment [default: 1]
   --constraint-activity-decay <double>  constraint activity decay [default: 0.999]
   --decision-heuristic arg              variable decision heuristic [default: VMTF]
@@ -64,12 +69,20 @@ General Options:
                                         (off | depqbf | weighted)
   --dependency-learning arg             dependency learning strategy
                                         (off | outermost | fewest | all) [default: all]
+  --dependency-sets arg                 representation of dependency sets [default: hash]
+                                        (hash | bitset)
+  --constraint-arena arg                allocation of constraint memory [default: malloc]
+                                        (malloc | mmap)
   --no-phase-saving                     deactivate phase saving
+  --no-minimization                     deactivate minimization of learned constraints
+  --trail-saving                        replay assignments undone by dependency learning backtracks
   --phase-heuristic arg                 phase selection heuristic [default: watcher]
                                         (invJW, qtype, watcher, random, false, true) 
   --partial-certificate                 output assignment to outermost block
   -v --verbose                          output information during solver run
   --print-stats                         print statistics on termination
+  --parse-only                          parse the input, report the load throughput and exit
+  --write-formula-cache <path>          write the parsed formula to a binary file, which can be given as input instead
 
 Weighted Model Generation Options:
   --exponent <double>                   exponent skewing the distribution of weights [default: 1]
@@ -141,6 +154,8 @@ int main(int argc, const char** argv)
   argument_constraints.push_back(make_unique<DoubleConstraint>("--constraint-activity-inc"));
   // argument_constraints.push_back(make_unique<DoubleConstraint>("--activity-threshold"));
   argument_constraints.push_back(make_unique<RegexArgumentConstraint>(non_neg_int, "--LBD-threshold", "unsigned int"));
+  argument_constraints.push_back(make_unique<RegexArgumentConstraint>(non_neg_int, "--tier2-LBD-threshold", "unsigned int"));
+  argument_constraints.push_back(make_unique<RegexArgumentConstraint>(non_neg_int, "--tier2-interval", "unsigned int"));
   argument_constraints.push_back(make_unique<DoubleRangeConstraint>(0, 1, "--constraint-activity-decay"));
 
   vector<string> decision_heuristics = {"VSIDS", "VMTF", "VMTF_ORD", "SGDB", "SPLIT_VMTF", "SPLIT_VSIDS", "EMAB"};
@@ -155,6 +170,12 @@ int main(int argc, const char** argv)
   vector<string> dependency_learning_strategies = {"off", "outermost", "fewest", "all"};
   argument_constraints.push_back(make_unique<ListConstraint>(dependency_learning_strategies, "--dependency-learning"));
 
+  vector<string> dependency_set_representations = {"hash", "bitset"};
+  argument_constraints.push_back(make_unique<ListConstraint>(dependency_set_representations, "--dependency-sets"));
+
+  vector<string> constraint_arena_policies = {"malloc", "mmap"};
+  argument_constraints.push_back(make_unique<ListConstraint>(constraint_arena_policies, "--constraint-arena"));
+
   vector<string> phase_heuristics = {"invJW", "qtype", "watcher", "random", "false", "true"};
   argument_constraints.push_back(make_unique<ListConstraint>(phase_heuristics, "--phase-heuristic"));
 
@@ -212,14 +233,18 @@ int main(int argc, const char** argv)
                                     std::stod(args["--term-removal-ratio"].asString()),
                                     args["--use-activity-threshold"].asBool(),
                                     std::stod(args["--constraint-activity-inc"].asString()),
-                                    static_cast<uint32_t>(args["--LBD-threshold"].asLong())
+                                    static_cast<uint32_t>(args["--LBD-threshold"].asLong()),
+                                    static_cast<uint32_t>(args["--tier2-LBD-threshold"].asLong()),
+                                    static_cast<uint32_t>(args["--tier2-interval"].asLong()),
+                                    args["--decreasing-LBD"].asBool(),
+                                    args["--constraint-arena"].asString() == "mmap" ? ArenaPolicy::mmap : ArenaPolicy::malloc
                                     );
   solver->constraint_database = &constraint_database;
   DebugHelper debug_helper(*solver);
   solver->debug_helper = &debug_helper;
   VariableDataStore variable_data_store(*solver);
   solver->variable_data_store = &variable_data_store;
-  DependencyManagerWatched dependency_manager(*solver, args["--dependency-learning"].asString());
+  DependencyManagerWatched dependency_manager(*solver, args["--dependency-learning"].asString(), args["--dependency-sets"].asString());
   solver->dependency_manager = &dependency_manager;
   unique_ptr<DecisionHeuristic> decision_heuristic;
 
@@ -245,6 +270,8 @@ int main(int argc, const char** argv)
     bool prefer_fewer_occurrences;
     if (args["--tiebreak"].asString() == "arbitrary") {
       tiebreak_scores = false;
+      use_secondary_occurrences = false;
+      prefer_fewer_occurrences = false;
     } else if (args["--tiebreak"].asString() == "more-primary") {
       tiebreak_scores = true;
       use_secondary_occurrences = false;
@@ -340,35 +367,64 @@ int main(int argc, const char** argv)
   }
 
   solver->restart_scheduler = restart_scheduler.get();
-  StandardLearningEngine learning_engine(*solver);
+  StandardLearningEngine learning_engine(*solver, args["--no-minimization"].asBool());
   solver->learning_engine = &learning_engine;
   WatchedLiteralPropagator propagator(
     *solver, 
     args["--model-generation"].asString() == "weighted",
     std::stod(args["--exponent"].asString()),
     std::stod(args["--scaling-factor"].asString()),
-    std::stod(args["--universal-penalty"].asString())
+    std::stod(args["--universal-penalty"].asString()),
+    args["--trail-saving"].asBool()
   );
   
   solver->propagator = &propagator;
 
-  Parser parser(*solver, args["--model-generation"].asString() != "off");
+  bool use_model_generation = args["--model-generation"].asString() != "off";
 
   // PARSER
+  unique_ptr<InputBuffer> input;
+  bool load_formula_cache = false;
   if (args["<path>"]) {
     string filename = args["<path>"].asString();
-  	ifstream ifs(filename);
-    if (!ifs.is_open()) {
+    input = make_unique<InputBuffer>(filename);
+    if (!input->isOpen()) {
       cerr << "qute: cannot access '" << filename << "': no such file or directory \n";
       return 2;
-    } else {
-      parser.readAUTO(ifs);
-      ifs.close();
     }
+    load_formula_cache = FormulaCache::isCacheFile(filename);
+  } else {
+    input = make_unique<InputBuffer>(std::cin);
   }
-  else {
-    parser.readAUTO();
+  auto parse_start = std::chrono::steady_clock::now();
+  uint64_t bytes_read;
+  if (load_formula_cache) {
+    bytes_read = FormulaCache::load(args["<path>"].asString(), *solver, use_model_generation);
+  } else {
+    // The formula is recorded on its way to the solver if it is to be written to a cache.
+    unique_ptr<FormulaCache> formula_cache;
+    if (args["--write-formula-cache"]) {
+      formula_cache = make_unique<FormulaCache>(*solver);
+    }
+    Parser parser(formula_cache ? static_cast<PCNFContainer&>(*formula_cache) : *solver, use_model_generation);
+    parser.readAUTO(*input);
+    bytes_read = input->bytesConsumed();
+    if (formula_cache && !formula_cache->write(args["--write-formula-cache"].asString(), use_model_generation)) {
+      cerr << "qute: cannot write formula cache '" << args["--write-formula-cache"].asString() << "'\n";
+      return 2;
+    }
+  }
+  if (args["--parse-only"].asBool()) {
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - parse_start).count();
+    double megabytes = bytes_read / 1e6;
+    cout << "Parsed " << megabytes << " MB in " << seconds << " s";
+    if (seconds > 0) {
+      cout << " (" << megabytes / seconds << " MB/s)";
+    }
+    cout << "\n";
+    return 0;
   }
+  input.reset();
 
   // LOGGING
   if (args["--verbose"].asBool()) {
@@ -12,9 +12,6 @@ const char QTYPE_FORALL = 'a';
 const char QTYPE_EXISTS = 'e';
 const char QTYPE_UNDEF = 0;
 
-const string QDIMACS_QTYPE_FORALL = "a";
-const string QDIMACS_QTYPE_EXISTS = "e";
-
 #define QCIR_BUFFER_SIZE 8192
 #define QCIR_QTYPE_COUNT 3
 
@@ -25,192 +22,224 @@ const char QCIR_QTYPE_MAP[QCIR_QTYPE_COUNT] = {QTYPE_EXISTS, QTYPE_FORALL, QTYPE
 
 const string QCIR_GATE[QCIR_GATE_COUNT] = {"and", "or", "xor", "ite"};
 
-auto& Parser::getline(std::istream& ifs, std::string& str) {
-    ++current_line;
-    return std::getline(ifs, str);
-}
-
-void Parser::readAUTO(std::istream& ifs) {
-    auto first_character = ifs.peek();
+void Parser::readAUTO(InputBuffer& input) {
+    input.skipWhitespace();
+    auto first_character = input.peek();
     if (first_character == 'p' || first_character == 'c') {
-        readQDIMACS(ifs);
+        readQDIMACS(input);
     } else {
-        readQCIR(ifs);
+        readQCIR(input);
     }
 }
 
-void Parser::readQDIMACS(istream& ifs) {
-    string token;
+void Parser::readQDIMACS(InputBuffer& input) {
+    /* Integers are scanned directly from the input buffer, and a single clause buffer is reused
+     * for the whole matrix, so that parsing does not allocate per token or per clause.
+     * The constraints are collected in batches and added to the container once the matrix is read.
+     */
 
     // discard leading comment lines
-    ifs >> token;
-    while (token == "c") {
-        getline(ifs, token);
-        ifs >> token;
+    input.skipWhitespace();
+    while (input.peek() == 'c') {
+        input.skipLine();
+        input.skipWhitespace();
     }
 
-    assert(token == "p");
-    ifs >> token;
-    assert(token == "cnf");
+    if (input.peek() != 'p') {
+        cerr << "Error: Missing problem line." << endl;
+        exit(1);
+    }
+    input.advance();
+    input.skipWhitespace();
+    for (char c: string("cnf")) {
+        if (input.peek() != c) {
+            cerr << "Error: Malformed problem line." << endl;
+            exit(1);
+        }
+        input.advance();
+    }
 
     // the declared number of clauses: when reading from the standard input, no more than this many will be read
-    uint32_t num_clauses;
+    int32_t num_clauses;
     // the declared bound on the number of variables
-    uint32_t max_var;
+    int32_t max_var;
 
-    ifs >> max_var;
-    ifs >> num_clauses;
+    if (!input.readInt(max_var) || !input.readInt(num_clauses) || max_var < 0 || num_clauses < 0) {
+        cerr << "Error: Malformed problem line." << endl;
+        exit(1);
+    }
 
     // the map that converts old variable name to the new one
     vector<Variable> var_conversion_map(max_var+1, 0);
 
     char current_qtype = QTYPE_UNDEF;
-    uint32_t current_var;
+    int32_t current_var;
     int vars_seen = 0;
 
-    bool empty_formula = true;
-
     // Read the prefix.
-    while (ifs >> token) {
-        if (token == QDIMACS_QTYPE_FORALL) {
-                current_qtype = QTYPE_FORALL;
-        } else if (token == QDIMACS_QTYPE_EXISTS) {
-                current_qtype = QTYPE_EXISTS;
+    while (true) {
+        input.skipWhitespace();
+        if (input.peek() == QTYPE_FORALL) {
+            current_qtype = QTYPE_FORALL;
+        } else if (input.peek() == QTYPE_EXISTS) {
+            current_qtype = QTYPE_EXISTS;
         } else {
-            /* The prefix has ended.
-             * We have, however, already read the first literal of the first clause.
-             * Therefore, when we jump out of the loop, we must take that literal into account.
-             */
-            empty_formula = false;
+            // The prefix has ended.
             break;
         }
+        input.advance();
 
-        ifs >> current_var;
-        while (current_var != 0) {
+        while (input.readInt(current_var) && current_var != 0) {
+            if (current_var < 0 || current_var > max_var) {
+                cerr << "Error: Variable " << current_var << " in the prefix exceeds the declared bound." << endl;
+                exit(1);
+            }
             vars_seen++;
             var_conversion_map[current_var] = vars_seen;
             pcnf.addVariable(to_string(current_var), current_qtype, false);
-            ifs >> current_var;
         }
     }
 
     // prepare the vector for the top-level term
     vector<Literal> top_level_term;
 
-    // Handle the case of an empty formula
-    if (!empty_formula) {
-        int32_t literal = stoi(token);
-
-        uint32_t clauses_seen = 0;
-
-        // Read the matrix.
-        do {
-            vector<Literal> temp_clause;
-            while (literal != 0) {
-                // Convert the read literal into the corresponding literal according to the renaming of variables.
-                int32_t variable = abs(literal);
-                if (var_conversion_map[variable] == 0) {
-                    cerr << "Error: Qute does not currently support free variables (" << literal << " is free), please bind all variables in the prefix." << endl;
-                    exit(1);
-                }
-                temp_clause.push_back(mkLiteral(var_conversion_map[variable], literal > 0));
-                ifs >> literal;
+    int32_t literal;
+    int32_t clauses_seen = 0;
+    vector<Literal> clause;
+    vector<Literal> term(2);
+    ConstraintBatch clause_batch, term_batch;
+    clause_batch.reserve(num_clauses, 0);
+
+    // Read the matrix.
+    while ((!input.isStandardInput() || clauses_seen < num_clauses) && input.readInt(literal)) {
+        clause.clear();
+        while (literal != 0) {
+            // Convert the read literal into the corresponding literal according to the renaming of variables.
+            int32_t variable = abs(literal);
+            if (variable > max_var || var_conversion_map[variable] == 0) {
+                cerr << "Error: Qute does not currently support free variables (" << literal << " is free), please bind all variables in the prefix." << endl;
+                exit(1);
             }
-            clauses_seen++;
-            sort(temp_clause.begin(), temp_clause.end());
-            bool tautological = false;
-            for (unsigned i = 1; i < temp_clause.size(); i++) {
-                if (temp_clause[i] == ~temp_clause[i-1]) {
-                    // Tautological clause, do not add.
-                    tautological = true;
-                    break;
-                }
+            clause.push_back(mkLiteral(var_conversion_map[variable], literal > 0));
+            if (!input.readInt(literal)) {
+                cerr << "Error: Unterminated clause at the end of the input." << endl;
+                exit(1);
             }
-            if (!tautological) {
-                pcnf.addConstraint(temp_clause, ConstraintType::clauses);
-                if (!use_model_generation) {
-                    // add all of the Tseitin terms
-                    vars_seen++;
-                    pcnf.addVariable(to_string(max_var + clauses_seen), QTYPE_FORALL, true);
-                    top_level_term.push_back(mkLiteral(vars_seen, true));
-                    for (auto lit: temp_clause) {
-                        pcnf.addDependency(vars_seen, var(lit));
-                        vector<Literal> term{lit, mkLiteral(vars_seen, false)};
-                        pcnf.addConstraint(term, ConstraintType::terms);
-                    }
+        }
+        clauses_seen++;
+        sort(clause.begin(), clause.end());
+        bool tautological = false;
+        for (unsigned i = 1; i < clause.size(); i++) {
+            if (clause[i] == ~clause[i-1]) {
+                // Tautological clause, do not add.
+                tautological = true;
+                break;
+            }
+        }
+        if (!tautological) {
+            clause_batch.add(clause);
+            if (!use_model_generation) {
+                // add all of the Tseitin terms
+                vars_seen++;
+                pcnf.addVariable(to_string(max_var + clauses_seen), QTYPE_FORALL, true);
+                top_level_term.push_back(mkLiteral(vars_seen, true));
+                for (auto lit: clause) {
+                    pcnf.addDependency(vars_seen, var(lit));
+                    term[0] = lit;
+                    term[1] = mkLiteral(vars_seen, false);
+                    term_batch.add(term);
                 }
             }
-        } while ((&ifs != &cin || clauses_seen < num_clauses) && ifs >> literal);
+        }
     }
+    pcnf.addConstraints(clause_batch, ConstraintType::clauses);
     if (!use_model_generation) {
-        pcnf.addConstraint(top_level_term, ConstraintType::terms);
+        term_batch.add(top_level_term);
+        pcnf.addConstraints(term_batch, ConstraintType::terms);
     }
 }
 
-void Parser::readQCIR(istream& ifs) {
-    string line;
-
-    qcir_var_conversion_map.clear();
+void Parser::readQCIR(InputBuffer& input) {
+    /* The whole input is scanned as a single buffer (a mapped file is used in place),
+     * and identifiers are looked up as views into it. The constraints are collected in
+     * batches and added to the container at the end.
+     */
+    string storage;
+    const char* input_begin;
+    const char* input_end;
+    input.remainingInput(input_begin, input_end, storage);
+
+    qcir_symbols.clear();
     nr_vars = 0;
     current_line = 0;
-    string qcir_output_clause_var = "", qcir_output_term_var = "";
+    StringRef qcir_output;
 
     bool is_prefix_line;
-    vector<string> inputs;
-    while (getline(ifs, line)) {
+    vector<StringRef> inputs;
+    const char* line_begin = input_begin;
+    while (line_begin < input_end) {
+        const char* line_end = static_cast<const char*>(memchr(line_begin, '\n', input_end - line_begin));
+        if (line_end == nullptr) {
+            line_end = input_end;
+        }
+        StringRef line(line_begin, line_end - line_begin);
+        line_begin = line_end + 1;
+        ++current_line;
         size_t idx = 0;
         skip_space(line, idx);
-        if (idx == line.size() || line[idx] == '#') {
+        if (idx == line.size || line[idx] == '#') {
             continue;
         }
-        string identifier = extract_next(line, idx, "(=");
+        StringRef identifier = extract_next(line, idx, "(=");
         is_prefix_line = (line[idx] == '(');
         if (is_prefix_line) {
-            std::transform(identifier.begin(), identifier.end(), identifier.begin(), ::tolower);
             bool is_quantifier_block = false;
             uint32_t qtype;
             for (qtype = 0; qtype < QCIR_QTYPE_COUNT; qtype++) {
-                if (identifier == QCIR_QTYPE[qtype]) {
+                if (equals_ignore_case(identifier, QCIR_QTYPE[qtype])) {
                     is_quantifier_block = true;
                     break;
                 }
             }
             if (is_quantifier_block) {
-                while (line[idx] != ')' && ++idx < line.size()) {
-                    pushQCIRVar(extract_next(line, idx, ",)"), QCIR_QTYPE_MAP[qtype], false);
+                while (line[idx] != ')' && ++idx < line.size) {
+                    StringRef name = extract_next(line, idx, ",)");
+                    if (qcir_symbols.find(name) != qcir_symbols.end()) {
+                        cerr << "Error: Variable '" << name.str() << "' already exists (line "  << current_line << ")" << endl;
+                        exit(1);
+                    }
+                    int32_t v = pushQCIRVar(name.str(), QCIR_QTYPE_MAP[qtype], false);
+                    qcir_symbols.insert({name, QCIRSymbol{v, v, false}});
                 }
-                if (idx >= line.size()) {
+                if (idx >= line.size) {
                     unexpected_eol_error();
                 }
-            } else if (identifier == "output") {
-                if (qcir_output_clause_var != "") {
+            } else if (equals_ignore_case(identifier, "output")) {
+                if (!qcir_output.empty()) {
                     cerr << "Error: Duplicate output gate at line " << current_line << endl;
                     exit(1);
                 }
-                string name = extract_next(line, ++idx, ")");
-                qcir_output_clause_var = name + ".e";
-                qcir_output_term_var = name + ".a";
+                qcir_output = extract_next(line, ++idx, ")");
             } else {
-                unknown_identifier_error(identifier);
+                unknown_identifier_error(identifier.str());
             }
         } else {
-            string gate_type = extract_next(line, ++idx, "(");
-            std::transform(gate_type.begin(), gate_type.end(), gate_type.begin(), ::tolower);
+            StringRef gate_type = extract_next(line, ++idx, "(");
             bool is_valid_gate = false;
             for (uint32_t i = 0; i < QCIR_GATE_COUNT; i++) {
-                if (gate_type == QCIR_GATE[i]) {
+                if (equals_ignore_case(gate_type, QCIR_GATE[i])) {
                     inputs.clear();
-                    while (line[idx] != ')' && ++idx < line.size()) {
+                    while (line[idx] != ')' && ++idx < line.size) {
                         inputs.push_back(extract_lit(line, idx));
                         if (inputs.back().empty()) {
                             if (inputs.size() > 1) {
                                 unexpected_char_error(line[idx], idx+1);
                             } else {
-								inputs.pop_back();
-							}
+                                inputs.pop_back();
+                            }
                         }
                     }
-                    if (idx >= line.size()) {
+                    if (idx >= line.size) {
                         unexpected_eol_error();
                     }
                     addQCIRGate(identifier, i, inputs);
@@ -219,161 +248,146 @@ void Parser::readQCIR(istream& ifs) {
                 }
             }
             if (!is_valid_gate) {
-                cerr << "Error: Unknown gate type '" << gate_type << "' at line " << current_line << endl;
+                cerr << "Error: Unknown gate type '" << gate_type.str() << "' at line " << current_line << endl;
                 exit(1);
             }
         }
     }
-    if (qcir_output_clause_var == "") {
+    if (qcir_output.empty()) {
         cerr << "Error: Output gate missing!" << endl;
         exit(1);
     }
-    vector<Literal> output_clause{mkLiteral(qcir_var_conversion_map.at(qcir_output_clause_var), true)};
-    vector<Literal> output_term{mkLiteral(qcir_var_conversion_map.at(qcir_output_term_var), true)};
-    pcnf.addConstraint(output_clause, ConstraintType::clauses);
-    pcnf.addConstraint(output_term, ConstraintType::terms);
+    auto output_symbol = qcir_symbols.find(qcir_output);
+    if (output_symbol == qcir_symbols.end()) {
+        cerr << "Error: Undeclared output gate '" << qcir_output.str() << "'" << endl;
+        exit(1);
+    }
+    addQCIRConstraint({mkLiteral(output_symbol->second.clause_var, true)}, ConstraintType::clauses);
+    addQCIRConstraint({mkLiteral(output_symbol->second.term_var, true)}, ConstraintType::terms);
+    for (ConstraintType constraint_type: constraint_types) {
+        pcnf.addConstraints(qcir_batches[constraint_type], constraint_type);
+        qcir_batches[constraint_type].clear();
+    }
+    // The keys are views into the input, which does not outlive this call.
+    qcir_symbols.clear();
 }
 
-void Parser::addQCIRGate(string gate_name, uint32_t gate_type, vector<string>& inputs) {
-    string existential_var_name = gate_name + ".e";
-    string universal_var_name = gate_name + ".a";
+void Parser::addQCIRGate(StringRef gate_name, uint32_t gate_type, vector<StringRef>& inputs) {
     // Detect duplicate gate definitions
-    if (qcir_var_conversion_map.find(gate_name) != qcir_var_conversion_map.end()) {
-        cerr << "Error: Variable '" << gate_name << "' already exists (line "  << current_line << ")" << endl;
-        exit(1);
-    }
-    if (qcir_var_conversion_map.find(existential_var_name) != qcir_var_conversion_map.end()) {
-        cerr << "Error: Duplicate gate definition at line " << current_line << endl;
+    auto existing = qcir_symbols.find(gate_name);
+    if (existing != qcir_symbols.end()) {
+        if (existing->second.gate) {
+            cerr << "Error: Duplicate gate definition at line " << current_line << endl;
+        } else {
+            cerr << "Error: Variable '" << gate_name.str() << "' already exists (line "  << current_line << ")" << endl;
+        }
         exit(1);
     }
-    vector<int32_t> clause_inputs, term_inputs;
-    clause_inputs.reserve(inputs.size());
-    term_inputs.reserve(inputs.size());
-    uint32_t num_empty_inputs = 0;
-    for (string& input : inputs) {
-        string clause_key, term_key;
+    vector<int32_t>& clause_inputs = qcir_clause_inputs;
+    vector<int32_t>& term_inputs = qcir_term_inputs;
+    clause_inputs.clear();
+    term_inputs.clear();
+    for (StringRef& input : inputs) {
         int32_t neg_multiplier = 1;
+        StringRef key = input;
         if (input[0] == '-') {
             neg_multiplier = -1;
-            clause_key = input.substr(1);
-            term_key = input.substr(1);
-        } else {
-            clause_key = input;
-            term_key = input;
-        }
-        if (clause_key == "") {
-            num_empty_inputs++;
+            key = StringRef(input.data + 1, input.size - 1);
         }
-        if (qcir_var_conversion_map.find(clause_key) == qcir_var_conversion_map.end()) {
-            clause_key += ".e";
-            term_key += ".a";
-        }
-        try {
-            clause_inputs.push_back(neg_multiplier * qcir_var_conversion_map.at(clause_key));
-            term_inputs.push_back(neg_multiplier * qcir_var_conversion_map.at(term_key));
-        } catch (out_of_range&) {
-            cerr << "Error: Undeclared literal '" << input << "' at line " << current_line << endl;
+        auto symbol = qcir_symbols.find(key);
+        if (symbol == qcir_symbols.end()) {
+            cerr << "Error: Undeclared literal '" << input.str() << "' at line " << current_line << endl;
             exit(1);
         }
+        clause_inputs.push_back(neg_multiplier * symbol->second.clause_var);
+        term_inputs.push_back(neg_multiplier * symbol->second.term_var);
+    }
+    string name = gate_name.str();
+    int32_t gate_clause_var = pushQCIRVar(name + ".e", QTYPE_EXISTS, true);
+    int32_t gate_term_var = pushQCIRVar(name + ".a", QTYPE_FORALL, true);
+    qcir_symbols.insert({gate_name, QCIRSymbol{gate_clause_var, gate_term_var, true}});
+    for (int32_t lit : clause_inputs) {
+        pcnf.addDependency(gate_clause_var, abs(lit));
+    }
+    for (int32_t lit : term_inputs) {
+        pcnf.addDependency(gate_term_var, abs(lit));
     }
-    pushQCIRVar(existential_var_name, QTYPE_EXISTS, true);
-    pushQCIRVar(universal_var_name, QTYPE_FORALL, true);
-    int32_t gate_clause_var = nr_vars - 1;
-    int32_t gate_term_var = nr_vars;
-	for (int32_t lit : clause_inputs) {
-			pcnf.addDependency(gate_clause_var, abs(lit));
-	}
-	for (int32_t lit : term_inputs) {
-			pcnf.addDependency(gate_term_var, abs(lit));
-	}
     Literal g_c = mkLiteral(gate_clause_var, true);
     Literal g_t = mkLiteral(gate_term_var, true);
 
     switch (gate_type) {
         case 0: {
             // AND gate
-            vector<Literal> big_constraint;
-
-            big_constraint.reserve(clause_inputs.size()+1);
             for (int32_t l: clause_inputs) {
                 Literal lit = mkLiteral(abs(l), l > 0);
-                vector<Literal> small_clause{lit, ~g_c};
-                pcnf.addConstraint(small_clause, ConstraintType::clauses);
-                big_constraint.push_back(~lit);
+                addQCIRConstraint({lit, ~g_c}, ConstraintType::clauses);
+            }
+            qcir_constraint.clear();
+            for (int32_t l: clause_inputs) {
+                qcir_constraint.push_back(~mkLiteral(abs(l), l > 0));
             }
-            big_constraint.push_back(g_c);
-            pcnf.addConstraint(big_constraint, ConstraintType::clauses);
-            big_constraint.clear();
+            qcir_constraint.push_back(g_c);
+            qcir_batches[ConstraintType::clauses].add(qcir_constraint);
 
-            big_constraint.reserve(term_inputs.size()+1);
             for (int32_t l: term_inputs) {
                 Literal lit = mkLiteral(abs(l), l > 0);
-                vector<Literal> small_term{~lit, g_t};
-                pcnf.addConstraint(small_term, ConstraintType::terms);
-                big_constraint.push_back(lit);
+                addQCIRConstraint({~lit, g_t}, ConstraintType::terms);
+            }
+            qcir_constraint.clear();
+            for (int32_t l: term_inputs) {
+                qcir_constraint.push_back(mkLiteral(abs(l), l > 0));
             }
-            big_constraint.push_back(~g_t);
-            pcnf.addConstraint(big_constraint, ConstraintType::terms);
+            qcir_constraint.push_back(~g_t);
+            qcir_batches[ConstraintType::terms].add(qcir_constraint);
             break;
         }
         case 1: {
             // OR gate
-            vector<Literal> big_constraint;
-
-            big_constraint.reserve(clause_inputs.size()+1);
             for (int32_t l: clause_inputs) {
                 Literal lit = mkLiteral(abs(l), l > 0);
-                vector<Literal> small_clause{~lit, g_c};
-                pcnf.addConstraint(small_clause, ConstraintType::clauses);
-                big_constraint.push_back(lit);
+                addQCIRConstraint({~lit, g_c}, ConstraintType::clauses);
             }
-            big_constraint.push_back(~g_c);
-            pcnf.addConstraint(big_constraint, ConstraintType::clauses);
-            big_constraint.clear();
+            qcir_constraint.clear();
+            for (int32_t l: clause_inputs) {
+                qcir_constraint.push_back(mkLiteral(abs(l), l > 0));
+            }
+            qcir_constraint.push_back(~g_c);
+            qcir_batches[ConstraintType::clauses].add(qcir_constraint);
 
-            big_constraint.reserve(term_inputs.size()+1);
             for (int32_t l: term_inputs) {
                 Literal lit = mkLiteral(abs(l), l > 0);
-                vector<Literal> small_term{lit, ~g_t};
-                pcnf.addConstraint(small_term, ConstraintType::terms);
-                big_constraint.push_back(~lit);
+                addQCIRConstraint({lit, ~g_t}, ConstraintType::terms);
+            }
+            qcir_constraint.clear();
+            for (int32_t l: term_inputs) {
+                qcir_constraint.push_back(~mkLiteral(abs(l), l > 0));
             }
-            big_constraint.push_back(g_t);
-            pcnf.addConstraint(big_constraint, ConstraintType::terms);
+            qcir_constraint.push_back(g_t);
+            qcir_batches[ConstraintType::terms].add(qcir_constraint);
             break;
         }
         case 2: {
-			// XOR gate
+            // XOR gate
             if (clause_inputs.size() != 2) {
                 cerr << "Error: The XOR gate at line " << current_line << " must have exactly 2 inputs" << endl;
                 exit(1);
             }
             Literal x = mkLiteral(abs(clause_inputs[0]), clause_inputs[0] > 0);
             Literal y = mkLiteral(abs(clause_inputs[1]), clause_inputs[1] > 0);
-            vector<vector<Literal>> clauses = {
-                {~g_c, ~x, ~y},
-                {~g_c,  x,  y},
-                { g_c, ~x,  y},
-                { g_c,  x, ~y}
-            };
-            for (vector<Literal>& c : clauses) {
-                pcnf.addConstraint(c, ConstraintType::clauses);
-            }
+            addQCIRConstraint({~g_c, ~x, ~y}, ConstraintType::clauses);
+            addQCIRConstraint({~g_c,  x,  y}, ConstraintType::clauses);
+            addQCIRConstraint({ g_c, ~x,  y}, ConstraintType::clauses);
+            addQCIRConstraint({ g_c,  x, ~y}, ConstraintType::clauses);
             x = mkLiteral(abs(term_inputs[0]), term_inputs[0] > 0);
             y = mkLiteral(abs(term_inputs[1]), term_inputs[1] > 0);
-            vector<vector<Literal>> terms = {
-                { g_t,  x,  y},
-                { g_t, ~x, ~y},
-                {~g_t,  x, ~y},
-                {~g_t, ~x,  y}
-            };
-            for (vector<Literal>& t : terms) {
-                pcnf.addConstraint(t, ConstraintType::terms);
-            }
+            addQCIRConstraint({ g_t,  x,  y}, ConstraintType::terms);
+            addQCIRConstraint({ g_t, ~x, ~y}, ConstraintType::terms);
+            addQCIRConstraint({~g_t,  x, ~y}, ConstraintType::terms);
+            addQCIRConstraint({~g_t, ~x,  y}, ConstraintType::terms);
             break;
         }
         case 3: {
-			// ITE gate
+            // ITE gate
             if (clause_inputs.size() != 3) {
                 cerr << "Error: The ITE gate at line " << current_line << " must have exactly 3 inputs" << endl;
                 exit(1);
@@ -381,37 +395,30 @@ void Parser::addQCIRGate(string gate_name, uint32_t gate_type, vector<string>& i
             Literal lit_cond = mkLiteral(abs(clause_inputs[0]), clause_inputs[0] > 0);
             Literal lit_then = mkLiteral(abs(clause_inputs[1]), clause_inputs[1] > 0);
             Literal lit_else = mkLiteral(abs(clause_inputs[2]), clause_inputs[2] > 0);
-            vector<vector<Literal>> clauses = {
-                {~g_c, ~lit_cond,  lit_then},
-                {~g_c,  lit_cond,  lit_else},
-                { g_c, ~lit_cond, ~lit_then},
-                { g_c,  lit_cond, ~lit_else}
-            };
-            for (vector<Literal>& c : clauses) {
-                pcnf.addConstraint(c, ConstraintType::clauses);
-            }
+            addQCIRConstraint({~g_c, ~lit_cond,  lit_then}, ConstraintType::clauses);
+            addQCIRConstraint({~g_c,  lit_cond,  lit_else}, ConstraintType::clauses);
+            addQCIRConstraint({ g_c, ~lit_cond, ~lit_then}, ConstraintType::clauses);
+            addQCIRConstraint({ g_c,  lit_cond, ~lit_else}, ConstraintType::clauses);
             lit_cond = mkLiteral(abs(term_inputs[0]), term_inputs[0] > 0);
             lit_then = mkLiteral(abs(term_inputs[1]), term_inputs[1] > 0);
             lit_else = mkLiteral(abs(term_inputs[2]), term_inputs[2] > 0);
-            vector<vector<Literal>> terms = {
-                { g_t,  lit_cond, ~lit_then},
-                { g_t, ~lit_cond, ~lit_else},
-                {~g_t,  lit_cond,  lit_then},
-                {~g_t, ~lit_cond,  lit_else}
-            };
-            for (vector<Literal>& t : terms) {
-                pcnf.addConstraint(t, ConstraintType::terms);
-            }
+            addQCIRConstraint({ g_t,  lit_cond, ~lit_then}, ConstraintType::terms);
+            addQCIRConstraint({ g_t, ~lit_cond, ~lit_else}, ConstraintType::terms);
+            addQCIRConstraint({~g_t,  lit_cond,  lit_then}, ConstraintType::terms);
+            addQCIRConstraint({~g_t, ~lit_cond,  lit_else}, ConstraintType::terms);
             break;
         }
     }
 }
 
-void Parser::pushQCIRVar(const string& var_name, char qtype, bool auxiliary) {
-    assert(qcir_var_conversion_map.find(var_name) == qcir_var_conversion_map.end());
+void Parser::addQCIRConstraint(std::initializer_list<Literal> literals, ConstraintType constraint_type) {
+    qcir_batches[constraint_type].add(literals);
+}
+
+int32_t Parser::pushQCIRVar(const string& var_name, char qtype, bool auxiliary) {
     nr_vars++;
-    qcir_var_conversion_map.insert({var_name, nr_vars});
     pcnf.addVariable(var_name + " ", qtype, auxiliary);
+    return nr_vars;
 }
 
 char * Parser::uintToCharArray(uint32_t x) {
@@ -5,43 +5,99 @@
 #include <fstream>
 #include <iostream>
 #include <string>
-#include <map>
+#include <cstring>
+#include <unordered_map>
+#include <initializer_list>
 #include "pcnf_container.hh"
+#include "input_buffer.hh"
 #include "solver_types.hh"
 
 namespace Qute {
 
+/* A view of a range of characters in the QCIR input, which must outlive the view.
+ * Identifiers are handled as views, so that no string is allocated per token.
+ */
+struct StringRef {
+    const char* data;
+    size_t size;
+
+    StringRef(): data(nullptr), size(0) {}
+    StringRef(const char* data, size_t size): data(data), size(size) {}
+
+    char operator[](size_t idx) const { return data[idx]; }
+    bool empty() const { return size == 0; }
+    std::string str() const { return std::string(data, size); }
+    bool operator==(const StringRef& other) const {
+        return size == other.size && memcmp(data, other.data, size) == 0;
+    }
+};
+
+struct StringRefHash {
+    // FNV-1a
+    size_t operator()(const StringRef& s) const {
+        uint64_t hash = 14695981039346656037ULL;
+        for (size_t i = 0; i < s.size; i++) {
+            hash = (hash ^ static_cast<unsigned char>(s.data[i])) * 1099511628211ULL;
+        }
+        return hash;
+    }
+};
+
 inline bool isQCIRNameChar(char c) {
     return c == '_' || ('0' <= c && c <= '9') || ('A' <= c && c <= 'Z') || ('a' <= c && c <= 'z');
 }
 
-inline void skip_space(const std::string& str, size_t& idx) {
-    while (idx < str.size() && std::isspace(str[idx])) {
+inline void skip_space(const StringRef& str, size_t& idx) {
+    while (idx < str.size && std::isspace(str[idx])) {
         ++idx;
     }
 }
 
+inline bool equals_ignore_case(const StringRef& str, const std::string& keyword) {
+    if (str.size != keyword.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < str.size; i++) {
+        if (std::tolower(str[i]) != keyword[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
 class Parser {
+    /* A QCIR variable is used as it is in both clauses and terms, whereas a gate
+     * is represented by one existential variable for clauses and one universal
+     * variable for terms.
+     */
+    struct QCIRSymbol {
+        int32_t clause_var;
+        int32_t term_var;
+        bool gate;
+    };
+
     PCNFContainer& pcnf;
     bool use_model_generation;
-    std::map<std::string, int32_t> qcir_var_conversion_map;
+    std::unordered_map<StringRef, QCIRSymbol, StringRefHash> qcir_symbols; // Only valid while readQCIR runs.
+    std::vector<int32_t> qcir_clause_inputs, qcir_term_inputs;
+    std::vector<Literal> qcir_constraint;
+    ConstraintBatch qcir_batches[2]; // Indexed by ConstraintType.
     int32_t nr_vars;
     uint32_t current_line;
 
     // helper methods
     char* uintToCharArray(uint32_t x);
-    void addQCIRVars(const std::string& vars, char qtype);
-    void pushQCIRVar(const std::string& var_name, char qtype, bool auxiliary);
-    void addQCIRGate(std::string gate_name, uint32_t gate_type, std::vector<std::string>& inputs);
+    int32_t pushQCIRVar(const std::string& var_name, char qtype, bool auxiliary);
+    void addQCIRGate(StringRef gate_name, uint32_t gate_type, std::vector<StringRef>& inputs);
+    void addQCIRConstraint(std::initializer_list<Literal> literals, ConstraintType constraint_type);
 
 public:
     Parser(PCNFContainer& pcnf, bool use_model_generation): pcnf(pcnf), use_model_generation(use_model_generation) {}
 
     // IO methods
-    auto& getline(std::istream& ifs, std::string& str);
-    void readAUTO(std::istream& ifs = std::cin);
-    void readQCIR(std::istream& ifs = std::cin);
-    void readQDIMACS(std::istream& ifs = std::cin);
+    void readAUTO(InputBuffer& input);
+    void readQCIR(InputBuffer& input);
+    void readQDIMACS(InputBuffer& input);
     void writeQDIMACS();
 
     inline void unexpected_char_error(const char c, size_t col) {
@@ -64,21 +120,25 @@ public:
         exit(1);
     }
 
-    /* checks whether pos < str.size() and str[pos] is contained in the string chars,
+    /* checks whether pos < str.size and str[pos] is contained in the string chars,
      * and if not prints the required errors */
-    inline void assert_string_has_char(const std::string& str, size_t pos, const std::string& chars) {
-        if (pos >= str.size()) {
+    inline void assert_string_has_char(const StringRef& str, size_t pos, const char* chars) {
+        if (pos >= str.size) {
             unexpected_eol_error();
-        } else if (chars.find(str[pos]) == std::string::npos) {
+        } else if (str[pos] == '\0' || strchr(chars, str[pos]) == nullptr) {
             unexpected_char_error(str[pos], pos+1);
         }
     } 
 
-    inline std::string extract_next(const std::string& str, size_t& idx, const std::string& delimiters) {
+    inline bool is_delimiter(char c, const char* delimiters) {
+        return c != '\0' && strchr(delimiters, c) != nullptr;
+    }
+
+    inline StringRef extract_next(const StringRef& str, size_t& idx, const char* delimiters) {
         skip_space(str, idx);
         size_t begin = idx;
         size_t length = 0;
-        while (idx < str.size() && delimiters.find(str[idx]) == std::string::npos) {
+        while (idx < str.size && !is_delimiter(str[idx], delimiters)) {
             if (isspace(str[idx])) {
                 skip_space(str, idx);
                 assert_string_has_char(str, idx, delimiters);
@@ -90,21 +150,20 @@ public:
                 unexpected_char_error(str[idx], idx+1);
             }
         }
-        if (idx == str.size()) {
+        if (idx == str.size) {
             unexpected_eol_error();
         }
         if (length == 0) {
             empty_identifier_error();
         }
-        //std::cerr << "extracted token: " << token << std::endl;
-        return str.substr(begin, length);
+        return StringRef(str.data + begin, length);
     }
 
-    inline std::string extract_lit(const std::string& str, size_t& idx) {
+    inline StringRef extract_lit(const StringRef& str, size_t& idx) {
         skip_space(str, idx);
         size_t begin = idx;
         size_t length = 0;
-        while (idx < str.size() && str[idx] != ',' && str[idx] != ')') {
+        while (idx < str.size && str[idx] != ',' && str[idx] != ')') {
             if (isspace(str[idx])) {
                 skip_space(str, idx);
                 assert_string_has_char(str, idx, ",)");
@@ -123,7 +182,7 @@ public:
                 unexpected_char_error(str[idx], idx+1);
             }
         }
-        if (idx == str.size()) {
+        if (idx == str.size) {
             unexpected_eol_error();
         }
         if (str[begin] == '-' && length == 1) {
@@ -133,8 +192,7 @@ public:
         if (length == 0 && str[idx] != ')') {
             unexpected_char_error(str[idx], idx+1);
         }
-        //std::cerr << "extracted literal: " << token << std::endl;
-        return str.substr(begin, length);
+        return StringRef(str.data + begin, length);
     }
 };
 
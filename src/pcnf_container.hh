@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <string>
+#include <initializer_list>
 #include "solver_types.hh"
 
 using std::string;
@@ -10,13 +11,63 @@ using std::vector;
 
 namespace Qute {
 
+/* Constraints of one type that are added to a PCNFContainer at once. The literals of all constraints are stored
+   consecutively, constraint i consists of the literals from offsets[i] up to offsets[i+1]. */
+struct ConstraintBatch {
+  vector<Literal> literals;
+  vector<size_t> offsets;
+
+  ConstraintBatch(): offsets(1, 0) {}
+  uint32_t size() const { return offsets.size() - 1; }
+  uint32_t constraintSize(uint32_t i) const { return offsets[i + 1] - offsets[i]; }
+  const Literal* constraintBegin(uint32_t i) const { return literals.data() + offsets[i]; }
+  void reserve(size_t nr_constraints, size_t nr_literals);
+  void add(const vector<Literal>& constraint);
+  void add(std::initializer_list<Literal> constraint);
+  void clear();
+};
+
 class PCNFContainer {
 
 public:
   virtual void addVariable(string original_name, char variable_type, bool auxiliary) = 0;
   virtual void addConstraint(vector<Literal>& literals, ConstraintType constraint_type) = 0;
   virtual void addDependency(Variable of, Variable on) = 0;
+  /* Adds all constraints of the batch, which may be rearranged in the process. Containers that
+     have no use for batches add the constraints one by one. */
+  virtual void addConstraints(ConstraintBatch& batch, ConstraintType constraint_type);
 };
+
+// Implementation of inline methods.
+
+inline void ConstraintBatch::reserve(size_t nr_constraints, size_t nr_literals) {
+  offsets.reserve(nr_constraints + 1);
+  literals.reserve(nr_literals);
+}
+
+inline void ConstraintBatch::add(const vector<Literal>& constraint) {
+  literals.insert(literals.end(), constraint.begin(), constraint.end());
+  offsets.push_back(literals.size());
+}
+
+inline void ConstraintBatch::add(std::initializer_list<Literal> constraint) {
+  literals.insert(literals.end(), constraint.begin(), constraint.end());
+  offsets.push_back(literals.size());
+}
+
+inline void ConstraintBatch::clear() {
+  literals.clear();
+  offsets.assign(1, 0);
+}
+
+inline void PCNFContainer::addConstraints(ConstraintBatch& batch, ConstraintType constraint_type) {
+  vector<Literal> literals;
+  for (uint32_t i = 0; i < batch.size(); i++) {
+    literals.assign(batch.constraintBegin(i), batch.constraintBegin(i) + batch.constraintSize(i));
+    addConstraint(literals, constraint_type);
+  }
+}
+
 }
 
 #endif
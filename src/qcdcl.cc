@@ -10,6 +10,7 @@ QCDCL_solver::~QCDCL_solver() {}
 void QCDCL_solver::addVariable(string original_name, char variable_type, bool auxiliary) {
   bool var_type = (variable_type == 'a');
   variable_data_store->addVariable(original_name, var_type);
+  constraint_database->addVariable();
   propagator->addVariable();
   decision_heuristic->addVariable(auxiliary);
   dependency_manager->addVariable(auxiliary);
@@ -18,8 +19,29 @@ void QCDCL_solver::addVariable(string original_name, char variable_type, bool au
 void QCDCL_solver::addConstraint(vector<Literal>& literals, ConstraintType constraint_type) {
   sort(literals.begin(), literals.end());
   literals.erase(unique(literals.begin(), literals.end()), literals.end());
-  CRef constraint_reference = constraint_database->addConstraint(literals, constraint_type, false);
-  propagator->addConstraint(constraint_reference, constraint_type);
+  // Watchers of input constraints are initialized by the propagator at the start of solving.
+  constraint_database->addConstraint(literals, constraint_type, false);
+}
+
+void QCDCL_solver::addConstraints(ConstraintBatch& batch, ConstraintType constraint_type) {
+  // Constraints are sorted and deduplicated in place, skipping those that already are, and moved to close the gaps.
+  size_t write_position = 0;
+  for (uint32_t i = 0; i < batch.size(); i++) {
+    auto begin = batch.literals.begin() + batch.offsets[i];
+    auto end = batch.literals.begin() + batch.offsets[i + 1];
+    if (std::adjacent_find(begin, end, [](Literal first, Literal second) { return second <= first; }) != end) {
+      sort(begin, end);
+      end = unique(begin, end);
+    }
+    batch.offsets[i] = write_position;
+    if (batch.literals.begin() + write_position != begin) {
+      std::copy(begin, end, batch.literals.begin() + write_position);
+    }
+    write_position += end - begin;
+  }
+  batch.offsets.back() = write_position;
+  batch.literals.resize(write_position);
+  constraint_database->addConstraints(batch, constraint_type);
 }
 
 void QCDCL_solver::addDependency(Variable of, Variable on) {
@@ -69,6 +91,8 @@ lbool QCDCL_solver::solve() {
         Variable unit_variable = var(unit_literal);
         dependency_manager->learnDependencies(unit_variable, literal_vector);
         auto decision_level_backtrack_before = variable_data_store->varDecisionLevel(unit_variable);
+        // Most of the undone assignments are typically still implied after learning dependencies.
+        propagator->saveTrail(decision_level_backtrack_before);
         backtrackBefore(decision_level_backtrack_before);
         solver_statistics.backtracks_dep++;
       }
@@ -86,11 +110,10 @@ lbool QCDCL_solver::solve() {
 bool QCDCL_solver::enqueue(Literal l, CRef reason) {
   Variable v = var(l);
   if (variable_data_store->isAssigned(v)) {
-    return (variable_data_store->assignment(v) == sign(l));
+    return variable_data_store->literalValue(l) == l_True;
   } else {
     //LOG(trace) << "Enqueue literal" << (reason == CRef_Undef ? "(decision)": "") << ": " << (sign(l) ? "" : "-") << var(l) << std::endl;
     variable_data_store->appendToTrail(l, reason);
-    propagator->notifyAssigned(l);
     decision_heuristic->notifyAssigned(l);
     dependency_manager->notifyAssigned(v);
     solver_statistics.nr_assignments++;
@@ -98,21 +121,16 @@ bool QCDCL_solver::enqueue(Literal l, CRef reason) {
   }
 }
 
-void QCDCL_solver::undoLast() {
-  Literal l = variable_data_store->popFromTrail();
-  //propagator->notifyUnassigned(l); // Not needed if we use watched literals.
-  decision_heuristic->notifyUnassigned(l);
-  //dependency_manager->notifyUnassigned(l); // Not needed if we use watched variables.
-}
-
 void QCDCL_solver::backtrackBefore(uint32_t target_decision_level) {
   solver_statistics.backtracks_total++;
   LOG(trace) << "Backtracking before decision level: " << target_decision_level << std::endl;
-  propagator->notifyBacktrack(target_decision_level);
   decision_heuristic->notifyBacktrack(target_decision_level); // Target decision level must be passed to the VMTF decision heuristic.
-  while (!variable_data_store->trailIsEmpty() && variable_data_store->decisionLevel() >= target_decision_level) {
-    undoLast();
-  }
+  // The undone suffix of the trail is passed on at once, rather than one literal at a time.
+  uint32_t trail_position = variable_data_store->trailPosition(target_decision_level);
+  decision_heuristic->notifyUnassignedRange(variable_data_store->trailBegin() + trail_position, variable_data_store->trailEnd());
+  // The propagator and the dependency manager use watchers and need not be notified of unassigned literals.
+  variable_data_store->popFromTrail(trail_position);
+  propagator->notifyBacktrack(target_decision_level); // The propagator resumes at the end of the reduced trail.
 }
 
 void QCDCL_solver::restart() {
@@ -4,6 +4,7 @@
 #include <vector>
 #include <iostream>
 #include <algorithm>
+#include <sys/resource.h>
 
 #include "pcnf_container.hh"
 #include "solver_types.hh"
@@ -41,6 +42,7 @@ public:
   virtual void addVariable(string original_name, char variable_type, bool auxiliary);
   virtual void addConstraint(vector<Literal>& literals, ConstraintType constraint_type);
   virtual void addDependency(Variable of, Variable on);
+  virtual void addConstraints(ConstraintBatch& batch, ConstraintType constraint_type);
 
   lbool solve();
   void interrupt();
@@ -63,14 +65,15 @@ public:
     uint32_t backtracks_dep = 0;
     uint32_t nr_decisions = 0;
     uint32_t nr_assignments = 0;
+    uint32_t nr_replayed = 0;
     uint32_t learned_total[2] = {0, 0};
     uint32_t learned_tautological[2] = {0, 0};
     uint32_t nr_dependencies = 0;
+    uint64_t minimized_literals[2] = {0, 0};
     //uint64_t learned_total_length[2] = {0, 0};
   } solver_statistics;
 
 protected:
-  void undoLast();
   void backtrackBefore(uint32_t target_decision_level);
   void restart();
   uint64_t computeNrTrivial();
@@ -90,15 +93,24 @@ inline void QCDCL_solver::printStatistics() {
   cout << "Number of learned tautological clauses: " << solver_statistics.learned_tautological[false] <<  "\n";
   cout << "Number of learned terms: " << solver_statistics.learned_total[true] << "\n";
   cout << "Number of learned contradictory terms: " << solver_statistics.learned_tautological[true] << "\n";
+  cout << "Number of literals removed from learned clauses by minimization: " << solver_statistics.minimized_literals[false] << "\n";
+  cout << "Number of literals removed from learned terms by minimization: " << solver_statistics.minimized_literals[true] << "\n";
   cout << "Number of decisions: " << solver_statistics.nr_decisions << "\n";
   if (solver_statistics.nr_assignments) {
     cout << "Fraction of decisions among assignments: " << double(solver_statistics.nr_decisions) / double(solver_statistics.nr_assignments) << "\n";
   }
   cout << "Number of backtracks: " << solver_statistics.backtracks_total << "\n";
   cout << "Number of backtracks caused by dependency learning: " << solver_statistics.backtracks_dep << "\n";
+  cout << "Number of assignments replayed from saved trails: " << solver_statistics.nr_replayed << "\n";
   if (computeNrTrivial()) {
       cout << "Learned dependencies as a fraction of trivial: " << double(solver_statistics.nr_dependencies) / double(computeNrTrivial()) << "\n";
   }
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    cout << "Maximum resident set size (KB): " << usage.ru_maxrss << "\n";
+    cout << "Number of minor page faults: " << usage.ru_minflt << "\n";
+    cout << "Number of major page faults: " << usage.ru_majflt << "\n";
+  }
 }
 
 }
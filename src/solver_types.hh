@@ -30,7 +30,7 @@ using std::hash;
 
 namespace Qute {
 
-typedef RegionAllocator<uint32_t>::Ref CRef;
+typedef RegionAllocator<uint32_t>::Ref CRef; // 64 bits wide when built with LARGE_ARENAS.
 const CRef CRef_Undef = RegionAllocator<uint32_t>::Ref_Undef;
 
 typedef int32_t Variable;
@@ -80,6 +80,8 @@ public:
     TrailIterator(const Literal* _lits) : lits(_lits){}
 
     void operator++()   { lits++; }
+    void operator--()   { lits--; }
+    TrailIterator operator+(uint32_t offset) const { return TrailIterator(lits + offset); }
     Literal  operator*() const { return *lits; }
 
     bool operator==(const TrailIterator& ti) const { return lits == ti.lits; }
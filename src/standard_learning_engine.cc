@@ -3,117 +3,124 @@
 
 namespace Qute {
 
-StandardLearningEngine::StandardLearningEngine(QCDCL_solver& solver): solver(solver) {}
+StandardLearningEngine::StandardLearningEngine(QCDCL_solver& solver, bool no_minimization): solver(solver), no_minimization(no_minimization) {}
 
 void StandardLearningEngine::analyzeConflict(CRef conflict_constraint_reference, ConstraintType constraint_type, vector<Literal>& literal_vector, uint32_t& decision_level_backtrack_before, Literal& unit_literal, bool& constraint_learned, vector<Literal>& conflict_side_literals) {
   Constraint& constraint = solver.constraint_database->getConstraint(conflict_constraint_reference, constraint_type);
   if (constraint.learnt) {
-    solver.constraint_database->updateLBD(constraint);
+    solver.constraint_database->updateLBD(constraint, constraint_type);
     solver.constraint_database->bumpConstraintActivity(constraint, constraint_type);
   }
   Literal rightmost_primary = Literal_Undef;
-  vector<bool> characteristic_function = constraintToCf(constraint, constraint_type, rightmost_primary);
-  reduced_last.resize(solver.variable_data_store->lastVariable() + 1);
-
-  vector<uint32_t> primary_literal_decision_level_counts = getPrimaryLiteralDecisionLevelCounts(constraint, constraint_type);
-  assert(getPrimaryLiteralDecisionLevelCounts(characteristic_function, rightmost_primary, constraint_type) == primary_literal_decision_level_counts);
-  vector<Literal> primary_trail;
+  initializeAnalysisData(constraint, constraint_type, rightmost_primary);
+  assert(primaryLiteralDecisionLevelCountsCorrect(constraint_type));
+  // The trail is walked backwards in place, starting from the most recent assignment.
+  TrailIterator trail_position = solver.variable_data_store->trailEnd();
 
-  for (TrailIterator it = solver.variable_data_store->trailBegin(); it != solver.variable_data_store->trailEnd(); ++it) {
-    if (solver.variable_data_store->varType(var(*it)) == constraint_type) {
-      primary_trail.push_back(*it);
-    }
-  }
-
-  while (rightmost_primary != Literal_Undef) { // Proceed as long as the constraint represented by "characteristic_function" is not empty.
-    Literal primary_assigned_last;
+  while (rightmost_primary != Literal_Undef) { // Proceed as long as the current constraint is not empty.
+    Literal primary_assigned_last = Literal_Undef;
     do {
-      assert(!primary_trail.empty());
-      primary_assigned_last = ~(primary_trail.back() ^ constraint_type);
-      conflict_side_literals.push_back(primary_trail.back());
-      primary_trail.pop_back();
-    } while (!characteristic_function[toInt(primary_assigned_last)]);
+      assert(trail_position != solver.variable_data_store->trailBegin());
+      --trail_position;
+      if (solver.variable_data_store->varType(var(*trail_position)) == constraint_type) {
+        primary_assigned_last = ~(*trail_position ^ constraint_type);
+        conflict_side_literals.push_back(*trail_position);
+      }
+    } while (primary_assigned_last == Literal_Undef || !contains(primary_assigned_last));
     // Check whether the result is asserting w.r.t. primary_assigned_last.
-    if (isAsserting(primary_assigned_last, characteristic_function, primary_literal_decision_level_counts, constraint_type)) {
-      // Constraint is asserting. Set return values and exit.
-      if (cfToLiteralVector(characteristic_function, literal_vector, rightmost_primary)) {
+    if (isAsserting(primary_assigned_last, constraint_type)) {
+      // Constraint is asserting. Minimize it, set return values and exit.
+      if (!no_minimization) {
+        solver.solver_statistics.minimized_literals[constraint_type] += minimize(primary_assigned_last, constraint_type, rightmost_primary);
+      }
+      if (toLiteralVector(literal_vector, rightmost_primary)) {
         solver.solver_statistics.learned_tautological[constraint_type]++;
       }
       unit_literal = primary_assigned_last;
       constraint_learned = true;
-      decision_level_backtrack_before = computeBackTrackLevel(primary_assigned_last, characteristic_function, rightmost_primary, constraint_type) + 1;
+      decision_level_backtrack_before = computeBackTrackLevel(primary_assigned_last, rightmost_primary, constraint_type) + 1;
+      clearAnalysisData(constraint_type);
       return;
     }
     CRef reason_reference = solver.variable_data_store->varReason(var(primary_assigned_last));
     assert(reason_reference != CRef_Undef);
     Constraint& reason = solver.constraint_database->getConstraint(reason_reference, constraint_type);
     if (reason.learnt) {
-      solver.constraint_database->updateLBD(reason);
+      solver.constraint_database->updateLBD(reason, constraint_type);
       solver.constraint_database->bumpConstraintActivity(reason, constraint_type);
     }
-    // Update "characteristic_function" to represent to resolvent (reduced). Also update "primary_literal_decision_level_counts".
-    //LOG(trace) << "Resolving: " << cfToString(characteristic_function, rightmost_primary) << " and " << solver.variable_data_store->constraintToString(reason) << " on " << (sign(primary_assigned_last) ? "" : "-") << var(primary_assigned_last) << std::endl;
-    resolveAndReduce(characteristic_function, reason, constraint_type, primary_assigned_last, rightmost_primary, primary_literal_decision_level_counts, literal_vector);
-    assert(getPrimaryLiteralDecisionLevelCounts(characteristic_function, rightmost_primary, constraint_type) == primary_literal_decision_level_counts);
+    // Update the current constraint to represent the resolvent (reduced). Also update "primary_literal_decision_level_counts".
+    //LOG(trace) << "Resolving: " << currentConstraintToString(rightmost_primary) << " and " << solver.variable_data_store->constraintToString(reason) << " on " << (sign(primary_assigned_last) ? "" : "-") << var(primary_assigned_last) << std::endl;
+    resolveAndReduce(reason, constraint_type, primary_assigned_last, rightmost_primary, literal_vector);
+    assert(primaryLiteralDecisionLevelCountsCorrect(constraint_type));
     if (!literal_vector.empty()) {
       // Illegal merge. Set return values and exit.
       unit_literal = primary_assigned_last;
       constraint_learned = false;
+      clearAnalysisData(constraint_type);
       return;
     }
   }
-  // The constraint represented by "characteristic_function" is empty, return.
+  // The current constraint is empty, return.
   constraint_learned = true;
+  clearAnalysisData(constraint_type);
 }
 
-vector<bool> StandardLearningEngine::constraintToCf(Constraint& constraint, ConstraintType constraint_type, Literal& rightmost_primary) {
-  vector<bool> characteristic_function(solver.variable_data_store->lastVariable() + solver.variable_data_store->lastVariable() + 2);
-  fill(characteristic_function.begin(), characteristic_function.end(), false);
+void StandardLearningEngine::initializeAnalysisData(Constraint& constraint, ConstraintType constraint_type, Literal& rightmost_primary) {
+  // Variables and decision levels may have been added since the last conflict.
+  literal_state.resize(solver.variable_data_store->lastVariable() + solver.variable_data_store->lastVariable() + 2, Absent);
+  reduced_last.resize(solver.variable_data_store->lastVariable() + 1);
+  if (primary_literal_decision_level_counts.size() < solver.variable_data_store->decisionLevel() + 1) {
+    primary_literal_decision_level_counts.resize(solver.variable_data_store->decisionLevel() + 1, 0);
+  }
   for (Literal l: constraint) {
     if (solver.variable_data_store->varType(var(l)) == constraint_type && rightmost_primary < l) {
       rightmost_primary = l;
     }
   }
   for (Literal l: constraint) {
-    characteristic_function[toInt(l)] = l <= rightmost_primary;
+    if (l <= rightmost_primary) {
+      addLiteral(l);
+      if (solver.variable_data_store->varType(var(l)) == constraint_type) {
+        assert(solver.variable_data_store->isAssigned(var(l)));
+        primary_literal_decision_level_counts[solver.variable_data_store->varDecisionLevel(var(l))]++;
+      }
+    }
   }
-  return characteristic_function;
 }
 
-vector<uint32_t> StandardLearningEngine::getPrimaryLiteralDecisionLevelCounts(vector<bool>& characteristic_function, Literal& rightmost_primary, ConstraintType constraint_type) {
-  vector<uint32_t> primary_decision_level_counts(solver.variable_data_store->decisionLevel() + 1);
-  fill(primary_decision_level_counts.begin(), primary_decision_level_counts.end(), 0);
-  vector<Literal> literal_vector;
-  cfToLiteralVector(characteristic_function, literal_vector, rightmost_primary);
-  for (Literal l: literal_vector) {
-    if (solver.variable_data_store->varType(var(l)) == constraint_type) {
-      assert(solver.variable_data_store->isAssigned(var(l)));
-      primary_decision_level_counts[solver.variable_data_store->varDecisionLevel(var(l))]++;
+void StandardLearningEngine::clearAnalysisData(ConstraintType constraint_type) {
+  for (Literal l: touched_literals) {
+    if (contains(l) && solver.variable_data_store->varType(var(l)) == constraint_type) {
+      // Every nonzero count belongs to the decision level of some primary that is still contained.
+      primary_literal_decision_level_counts[solver.variable_data_store->varDecisionLevel(var(l))] = 0;
     }
+    literal_state[toInt(l)] = Absent;
   }
-  return primary_decision_level_counts;
+  touched_literals.clear();
 }
 
-vector<uint32_t> StandardLearningEngine::getPrimaryLiteralDecisionLevelCounts(Constraint& constraint, ConstraintType constraint_type) {
-  vector<uint32_t> primary_decision_level_counts(solver.variable_data_store->decisionLevel() + 1);
+bool StandardLearningEngine::primaryLiteralDecisionLevelCountsCorrect(ConstraintType constraint_type) {
+  vector<uint32_t> primary_decision_level_counts(primary_literal_decision_level_counts.size());
   fill(primary_decision_level_counts.begin(), primary_decision_level_counts.end(), 0);
-  for (Literal l: constraint) {
-    if (solver.variable_data_store->varType(var(l)) == constraint_type) {
+  for (Literal l: touched_literals) {
+    if (contains(l) && solver.variable_data_store->varType(var(l)) == constraint_type) {
       assert(solver.variable_data_store->isAssigned(var(l)));
       primary_decision_level_counts[solver.variable_data_store->varDecisionLevel(var(l))]++;
     }
   }
-  return primary_decision_level_counts;
+  return primary_decision_level_counts == primary_literal_decision_level_counts;
 }
 
-bool StandardLearningEngine::isAsserting(Literal last_literal, vector<bool>& characteristic_function, vector<uint32_t>& primary_literal_decision_level_counts, ConstraintType constraint_type) {
+bool StandardLearningEngine::isAsserting(Literal last_literal, ConstraintType constraint_type) {
   uint32_t decision_level_last_literal = solver.variable_data_store->varDecisionLevel(var(last_literal));
   if (decision_level_last_literal == 0 || primary_literal_decision_level_counts[decision_level_last_literal] > 1 || solver.variable_data_store->decisionLevelType(decision_level_last_literal) != constraint_type) {
     return false;
   }
-  for (int i = Min_Literal_Int; i < toInt(last_literal); i++) { // Every secondary var(last_literal) depends is to the left of var(last_literal) in the prefix.
-    Variable v = i >> 1;
-    if (characteristic_function[i] && solver.variable_data_store->varType(v) != constraint_type && solver.dependency_manager->dependsOn(var(last_literal), v) && 
+  for (Literal l: touched_literals) {
+    Variable v = var(l);
+    // Every secondary var(last_literal) depends on is to the left of var(last_literal) in the prefix.
+    if (contains(l) && l < last_literal && solver.variable_data_store->varType(v) != constraint_type && solver.dependency_manager->dependsOn(var(last_literal), v) &&
         (!solver.variable_data_store->isAssigned(v) || solver.variable_data_store->varDecisionLevel(v) >= decision_level_last_literal)) {
       return false;
     }
@@ -121,8 +128,8 @@ bool StandardLearningEngine::isAsserting(Literal last_literal, vector<bool>& cha
   return true;
 }
 
-void StandardLearningEngine::resolveAndReduce(vector<bool>& characteristic_function, Constraint& reason, ConstraintType constraint_type, Literal pivot, Literal& rightmost_primary, vector<uint32_t>& primary_literal_decision_level_counts, vector<Literal>& literal_vector) {
-  characteristic_function[toInt(pivot)] = false;
+void StandardLearningEngine::resolveAndReduce(Constraint& reason, ConstraintType constraint_type, Literal pivot, Literal& rightmost_primary, vector<Literal>& literal_vector) {
+  removeLiteral(pivot);
   primary_literal_decision_level_counts[solver.variable_data_store->varDecisionLevel(var(pivot))]--;
   vector<Literal> secondary_literals_reason;
   for (Literal l: reason) {
@@ -131,8 +138,8 @@ void StandardLearningEngine::resolveAndReduce(vector<bool>& characteristic_funct
     }
     if (solver.variable_data_store->varType(var(l)) == constraint_type) {
       // Primary literal.
-      if (!characteristic_function[toInt(l)]) {
-        characteristic_function[toInt(l)] = true;
+      if (!contains(l)) {
+        addLiteral(l);
         if (rightmost_primary < l) {
           rightmost_primary = l;
         }
@@ -140,7 +147,7 @@ void StandardLearningEngine::resolveAndReduce(vector<bool>& characteristic_funct
       }
     } else {
       // Secondary literal.
-      if (characteristic_function[toInt(~l)] && l < pivot) {
+      if (contains(~l) && l < pivot) {
         // Illegal merge. Add to vector of dependencies to be learned.
         literal_vector.push_back(l);
       } else {
@@ -151,30 +158,122 @@ void StandardLearningEngine::resolveAndReduce(vector<bool>& characteristic_funct
   if (literal_vector.empty()) {
     // No illegal merges occurred.
     if (rightmost_primary == pivot) {
-      // Look for new rightmost primary literal, reduce secondaries along the way.
-      rightmost_primary = Literal_Undef;
-      for (unsigned i = toInt(pivot); i >= Min_Literal_Int; i--) {
-        Variable v = i >> 1;
-        if (characteristic_function[i] && solver.variable_data_store->varType(v) == constraint_type) {
-          rightmost_primary = toLiteral(i);
-          break;
-        } else if (characteristic_function[i]) {
-          characteristic_function[i] = false;
-          reduced_last[v] = sign(toLiteral(i));
-        }
-      }
+      findRightmostPrimaryAndReduce(constraint_type, rightmost_primary);
     }
     for (Literal l: secondary_literals_reason) {
-      characteristic_function[toInt(l)] = l < rightmost_primary;
+      if (l < rightmost_primary) {
+        addLiteral(l);
+      }
+    }
+  }
+}
+
+uint32_t StandardLearningEngine::findRightmostPrimaryAndReduce(ConstraintType constraint_type, Literal& rightmost_primary) {
+  // Look for new rightmost primary literal, then reduce the secondaries to its right.
+  rightmost_primary = Literal_Undef;
+  for (Literal l: touched_literals) {
+    if (contains(l) && solver.variable_data_store->varType(var(l)) == constraint_type && rightmost_primary < l) {
+      rightmost_primary = l;
+    }
+  }
+  for (Literal l: touched_literals) {
+    if (contains(l) && rightmost_primary < l) {
+      // If both literals of a variable are reduced, the negative one is recorded.
+      reduced_last[var(l)] = sign(l) && !contains(~l);
+    }
+  }
+  uint32_t nr_reduced = 0;
+  for (Literal l: touched_literals) {
+    if (contains(l) && rightmost_primary < l) {
+      removeLiteral(l);
+      nr_reduced++;
+    }
+  }
+  return nr_reduced;
+}
+
+uint32_t StandardLearningEngine::minimize(Literal unit_literal, ConstraintType constraint_type, Literal& rightmost_primary) {
+  /* Remove primary literals whose reasons are subsumed by the learned constraint (possibly after recursively
+     resolving away further primaries). All redundancy checks refer to the constraint before any removal. */
+  vector<Literal> primaries;
+  for (Literal l: touched_literals) {
+    if (contains(l) && l != unit_literal && solver.variable_data_store->varType(var(l)) == constraint_type) {
+      primaries.push_back(l);
+    }
+  }
+  vector<Literal> redundant_primaries;
+  for (Literal l: primaries) {
+    if (isRedundant(l, constraint_type)) {
+      redundant_primaries.push_back(l);
+    }
+  }
+  bool rightmost_primary_removed = false;
+  for (Literal l: redundant_primaries) {
+    removeLiteral(l);
+    primary_literal_decision_level_counts[solver.variable_data_store->varDecisionLevel(var(l))]--;
+    rightmost_primary_removed = rightmost_primary_removed || l == rightmost_primary;
+  }
+  uint32_t nr_removed = redundant_primaries.size();
+  /* Secondaries are reduced w.r.t. the prefix order only: learned dependencies under-approximate the actual
+     dependencies, so a missing dependency does not justify reduction. */
+  if (rightmost_primary_removed) {
+    nr_removed += findRightmostPrimaryAndReduce(constraint_type, rightmost_primary);
+  }
+  return nr_removed;
+}
+
+bool StandardLearningEngine::isRedundant(Literal literal, ConstraintType constraint_type) {
+  /* A primary literal is redundant if resolving the learned constraint with its reason yields a subset of the
+     learned constraint, where primaries of the reason may in turn be redundant. Secondaries of a reason must
+     occur in the learned constraint without their complement, so that no complementary literals are merged.
+     Primaries assigned at a decision level without primaries in the learned constraint are not explored.
+     As in MiniSat, reasons are explored depth-first: a primary is marked Redundant once its whole reason has been
+     explored, and when a check fails the primaries on the current path are marked Failed. The learned constraint
+     does not change until all checks are done, so both marks remain valid for later checks of the same analysis. */
+  if (solver.variable_data_store->varReason(var(literal)) == CRef_Undef) {
+    return false;
+  }
+  redundancy_stack.clear();
+  redundancy_stack.emplace_back(literal);
+  while (!redundancy_stack.empty()) {
+    Literal current = redundancy_stack.back().literal;
+    Constraint& reason = solver.constraint_database->getConstraint(solver.variable_data_store->varReason(var(current)), constraint_type);
+    if (redundancy_stack.back().next == reason.size) {
+      redundancy_stack.pop_back();
+      if (current != literal) {
+        markLiteral(current, Redundant);
+      }
+      continue;
+    }
+    Literal l = reason[redundancy_stack.back().next++];
+    if (var(l) == var(current)) {
+      continue;
+    } else if (solver.variable_data_store->varType(var(l)) != constraint_type) {
+      // Secondary literal.
+      if (contains(l) && !contains(~l)) {
+        continue;
+      }
+    } else if (contains(l) || literal_state[toInt(l)] == Redundant) {
+      continue;
+    } else if (literal_state[toInt(l)] != Failed && solver.variable_data_store->varReason(var(l)) != CRef_Undef &&
+               primary_literal_decision_level_counts[solver.variable_data_store->varDecisionLevel(var(l))] > 0) {
+      redundancy_stack.emplace_back(l);
+      continue;
     }
+    // The literal under examination itself is contained in the learned constraint and must keep its state.
+    for (uint32_t i = 1; i < redundancy_stack.size(); i++) {
+      markLiteral(redundancy_stack[i].literal, Failed);
+    }
+    return false;
   }
+  return true;
 }
 
-uint32_t StandardLearningEngine::computeBackTrackLevel(Literal literal, vector<bool>& characteristic_function, Literal rightmost_primary, ConstraintType constraint_type) {
+uint32_t StandardLearningEngine::computeBackTrackLevel(Literal literal, Literal rightmost_primary, ConstraintType constraint_type) {
   uint32_t backtrack_level = 0;
-  for (int i = Min_Literal_Int; i <= toInt(rightmost_primary); i++) {
-    Variable v = i >> 1;
-    if (characteristic_function[i] && toLiteral(i) != literal && solver.variable_data_store->isAssigned(v) && solver.variable_data_store->varDecisionLevel(v) > backtrack_level &&
+  for (Literal l: touched_literals) {
+    Variable v = var(l);
+    if (contains(l) && l <= rightmost_primary && l != literal && solver.variable_data_store->isAssigned(v) && solver.variable_data_store->varDecisionLevel(v) > backtrack_level &&
         (solver.variable_data_store->varType(v) == constraint_type || solver.dependency_manager->dependsOn(var(literal), v))) {
       backtrack_level = solver.variable_data_store->varDecisionLevel(v);
     }
@@ -182,9 +281,9 @@ uint32_t StandardLearningEngine::computeBackTrackLevel(Literal literal, vector<b
   return backtrack_level;
 }
 
-string StandardLearningEngine::cfToString(vector<bool>& characteristic_function, Literal rightmost_primary) const {
+string StandardLearningEngine::currentConstraintToString(Literal rightmost_primary) const {
   vector<Literal> literal_vector;
-  cfToLiteralVector(characteristic_function, literal_vector, rightmost_primary);
+  toLiteralVector(literal_vector, rightmost_primary);
   return solver.variable_data_store->literalVectorToString(literal_vector);
 }
 
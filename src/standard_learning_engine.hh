@@ -17,53 +17,90 @@ namespace Qute {
 class StandardLearningEngine: public LearningEngine {
 
 public:
-  StandardLearningEngine(QCDCL_solver& solver);
+  StandardLearningEngine(QCDCL_solver& solver, bool no_minimization);
   virtual void analyzeConflict(CRef conflict_constraint_reference, ConstraintType constraint_type, 
                                vector<Literal>& literal_vector, uint32_t& decision_level_backtrack_before, 
                                Literal& unit_literal, bool& constraint_learned, vector<Literal>& conflict_side_literals);
   string reducedLast();
 
 protected:
-  vector<bool> constraintToCf(Constraint& constraint, ConstraintType constraint_type, Literal& rightmost_primary);
-  bool cfToLiteralVector(vector<bool>& characteristic_function, vector<Literal>& literal_vector, Literal& rightmost_primary) const;
-  vector<uint32_t> getPrimaryLiteralDecisionLevelCounts(Constraint& constraint, ConstraintType constraint_type);
-  vector<uint32_t> getPrimaryLiteralDecisionLevelCounts(vector<bool>& characteristic_function, Literal& rightmost_primary, ConstraintType constraint_type);
-  bool isAsserting(Literal last_literal, vector<bool>& characteristic_function, vector<uint32_t>& primary_literal_decision_level_counts, ConstraintType constraint_type);
-  void resolveAndReduce(vector<bool>& characteristic_function, Constraint& reason, ConstraintType constraint_type, Literal pivot, Literal& rightmost_primary, vector<uint32_t>& primary_literal_decision_level_counts, vector<Literal>& literal_vector);
-  uint32_t computeBackTrackLevel(Literal literal, vector<bool>& characteristic_function, Literal rightmost_primary, ConstraintType constraint_type);
-  string cfToString(vector<bool>& characteristic_function, Literal rightmost_primary) const;
+  /* The constraint derived during conflict analysis is represented sparsely: "literal_state" records for every literal
+     whether it is contained in the current constraint, and "touched_literals" lists every literal that has been added
+     during the current analysis. Only touched entries are reset afterwards, so the cost of analyzing a conflict is
+     proportional to the number of literals involved rather than to the number of variables. */
+  enum LiteralState: uint8_t { Absent = 0, Present = 1, Removed = 2, Redundant = 3, Failed = 4 };
 
-  vector<Literal> cfToVector(vector<bool>& characteristic_function, Literal rightmost_primary);
+  // A primary on the path of a redundancy check, with the index of the next literal of its reason to be explored.
+  struct RedundancyFrame {
+    Literal literal;
+    uint32_t next;
+    RedundancyFrame(Literal literal): literal(literal), next(0) {}
+  };
+
+  void initializeAnalysisData(Constraint& constraint, ConstraintType constraint_type, Literal& rightmost_primary);
+  void clearAnalysisData(ConstraintType constraint_type);
+  bool contains(Literal l) const;
+  void addLiteral(Literal l);
+  void removeLiteral(Literal l);
+  void markLiteral(Literal l, LiteralState state);
+  bool toLiteralVector(vector<Literal>& literal_vector, Literal rightmost_primary) const;
+  bool isAsserting(Literal last_literal, ConstraintType constraint_type);
+  void resolveAndReduce(Constraint& reason, ConstraintType constraint_type, Literal pivot, Literal& rightmost_primary, vector<Literal>& literal_vector);
+  uint32_t findRightmostPrimaryAndReduce(ConstraintType constraint_type, Literal& rightmost_primary);
+  uint32_t minimize(Literal unit_literal, ConstraintType constraint_type, Literal& rightmost_primary);
+  bool isRedundant(Literal literal, ConstraintType constraint_type);
+  uint32_t computeBackTrackLevel(Literal literal, Literal rightmost_primary, ConstraintType constraint_type);
+  bool primaryLiteralDecisionLevelCountsCorrect(ConstraintType constraint_type);
+  string currentConstraintToString(Literal rightmost_primary) const;
 
   QCDCL_solver& solver;
+  bool no_minimization;
   vector<bool> reduced_last;
+  vector<uint8_t> literal_state;
+  vector<Literal> touched_literals;
+  vector<uint32_t> primary_literal_decision_level_counts;
+  vector<RedundancyFrame> redundancy_stack;
 };
 
 // Implementation of inline methods.
 
-inline bool StandardLearningEngine::cfToLiteralVector(vector<bool>& characteristic_function, vector<Literal>& literal_vector, Literal& rightmost_primary) const {
+inline bool StandardLearningEngine::contains(Literal l) const {
+  return literal_state[toInt(l)] == Present;
+}
+
+inline void StandardLearningEngine::addLiteral(Literal l) {
+  if (literal_state[toInt(l)] == Absent) {
+    touched_literals.push_back(l);
+  }
+  literal_state[toInt(l)] = Present;
+}
+
+inline void StandardLearningEngine::removeLiteral(Literal l) {
+  literal_state[toInt(l)] = Removed;
+}
+
+inline void StandardLearningEngine::markLiteral(Literal l, LiteralState state) {
+  if (literal_state[toInt(l)] == Absent) {
+    touched_literals.push_back(l);
+  }
+  literal_state[toInt(l)] = state;
+}
+
+inline bool StandardLearningEngine::toLiteralVector(vector<Literal>& literal_vector, Literal rightmost_primary) const {
   bool taut = false;
-  for (int i = Min_Literal_Int; i <= toInt(rightmost_primary); i++) {
-    if (characteristic_function[i]) {
-      literal_vector.push_back(toLiteral(i));
-      if (characteristic_function[toInt(~toLiteral(i))]) {
+  auto first_new = literal_vector.size();
+  for (Literal l: touched_literals) {
+    if (contains(l) && l <= rightmost_primary) {
+      literal_vector.push_back(l);
+      if (contains(~l)) {
         taut = true;
       }
     }
   }
+  std::sort(literal_vector.begin() + first_new, literal_vector.end());
   return taut;
 }
 
-inline vector<Literal> cfToVector(vector<bool>& characteristic_function, Literal rightmost_primary) {
-  vector<Literal> result;
-  for (int i = Min_Literal_Int; i <= toInt(rightmost_primary); i++) {
-    if (characteristic_function[i]) {
-      result.push_back(toLiteral(i));
-    }
-  }
-  return result;
-}
-
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -2,43 +2,49 @@
 
 namespace Qute {
 
-VariableDataStore::VariableDataStore(QCDCL_solver& solver): solver(solver), last_variable(0) {}
+VariableDataStore::VariableDataStore(QCDCL_solver& solver): literal_value(Min_Literal_Int, l_Undef), variable_type(1), variable_decision_level(1), variable_reason(1, CRef_Undef), solver(solver), last_variable(0) {}
 
 void VariableDataStore::addVariable(string original_name, bool type) {
   variable_name.push_back(original_name);
-  variable_data.emplace_back();
-  assignment_data.emplace_back(type);
+  literal_value.push_back(l_Undef);
+  literal_value.push_back(l_Undef);
+  variable_type.push_back(type);
+  variable_decision_level.push_back(0);
+  variable_reason.push_back(CRef_Undef);
   last_variable++;
 }
 
 void VariableDataStore::appendToTrail(Literal l, CRef reason) {
-  trail.push_back(l);
   Variable v = var(l);
-  assignment_data[v - 1].is_assigned = true;
-  assignment_data[v - 1].assignment = sign(l);
-  variable_data[v - 1].reason = reason;
+  literal_value[toInt(l)] = l_True;
+  literal_value[toInt(~l)] = l_False;
+  variable_reason[v] = reason;
   if (reason == CRef_Undef) {
     decisions.push_back(v);
+    decision_trail_positions.push_back(trail.size());
   }
-  variable_data[v - 1].decision_level = decisions.size();
+  trail.push_back(l);
+  variable_decision_level[v] = decisions.size();
 }
 
-Literal VariableDataStore::popFromTrail() {
-  Literal last_literal = trail.back();
-  Variable v = var(last_literal);
-  CRef reason = varReason(v);
-  if (reason == CRef_Undef) {
+void VariableDataStore::popFromTrail(uint32_t trail_position) {
+  // Unassigns every literal from trail_position to the end of the trail at once.
+  for (uint32_t i = trail_position; i < trail.size(); i++) {
+    Literal l = trail[i];
+    literal_value[toInt(l)] = l_Undef;
+    literal_value[toInt(~l)] = l_Undef;
+  }
+  trail.resize(trail_position);
+  while (!decision_trail_positions.empty() && decision_trail_positions.back() >= trail_position) {
     decisions.pop_back();
+    decision_trail_positions.pop_back();
   }
-  trail.pop_back();
-  assignment_data[v - 1].is_assigned = false;
-  return last_literal;
 }
 
 void VariableDataStore::relocConstraintReferences(ConstraintType constraint_type) {
   for (Variable v = 1; v <= lastVariable(); v++) {
     if (varType(v) == constraint_type && varReason(v) != CRef_Undef) {
-      solver.constraint_database->relocate(variable_data[v - 1].reason, constraint_type);
+      solver.constraint_database->relocate(variable_reason[v], constraint_type);
     }
   }
 }
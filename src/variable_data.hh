@@ -24,45 +24,40 @@ public:
   bool varType(Variable v) const;
   bool isAssigned(Variable v) const;
   bool assignment(Variable v) const;
+  lbool literalValue(Literal l) const;
   void appendToTrail(Literal l, CRef reason);
   uint32_t decisionLevel() const;
   uint32_t varDecisionLevel(Variable v) const;
   bool decisionLevelType(uint32_t decision_level);
   CRef varReason(Variable v) const;
-  Literal popFromTrail();
+  void popFromTrail(uint32_t trail_position);
   bool trailIsEmpty() const;
   Variable lastVariable() const;
   TrailIterator trailBegin() const;
   TrailIterator trailEnd() const;
+  uint32_t trailSize() const;
+  Literal trailLiteral(uint32_t position) const;
+  uint32_t trailPosition(uint32_t decision_level) const;
   void relocConstraintReferences(ConstraintType constraint_type);
   string constraintToString(Constraint& constraint) const;
   string literalVectorToString(vector<Literal>& literal_vector) const;
   bool allAssigned() const;
 
 protected:
-  struct AssignmentData
-  {
-    bool is_assigned: 1;
-    bool assignment: 1;
-    bool type: 1;
-    AssignmentData(bool type): is_assigned(false), assignment(false), type(type) {}
-  };
-
-  struct VariableData
-  {
-    uint32_t decision_level;
-    CRef reason;
-    VariableData(): reason(CRef_Undef) {}
-  };
-
+  /* Assignments are stored per literal (indexed by toInt(l)), so that the value of a literal
+     can be read with a single lookup. Variable data is indexed by the variable itself,
+     index 0 and literal indices 0 and 1 are unused. */
   vector<Literal> trail;
-  vector<VariableData> variable_data;
-  vector<AssignmentData> assignment_data;
+  vector<lbool> literal_value;
+  vector<bool> variable_type;
+  vector<uint32_t> variable_decision_level;
+  vector<CRef> variable_reason;
   vector<string> variable_name;
 
   QCDCL_solver& solver;
   Variable last_variable;
   vector<Variable> decisions;
+  vector<uint32_t> decision_trail_positions; // Trail position of each decision.
 
 };
 
@@ -73,15 +68,19 @@ inline string VariableDataStore::originalName(Variable v) const {
 }
 
 inline bool VariableDataStore::varType(Variable v) const {
-  return assignment_data[v - 1].type;
+  return variable_type[v];
 }
 
 inline bool VariableDataStore::isAssigned(Variable v) const {
-  return assignment_data[v - 1].is_assigned;
+  return literal_value[toInt(mkLiteral(v))] != l_Undef;
 }
 
 inline bool VariableDataStore::assignment(Variable v) const {
-  return assignment_data[v - 1].assignment;
+  return literal_value[toInt(mkLiteral(v, true))] == l_True;
+}
+
+inline lbool VariableDataStore::literalValue(Literal l) const {
+  return literal_value[toInt(l)];
 }
 
 inline uint32_t VariableDataStore::decisionLevel() const {
@@ -89,7 +88,7 @@ inline uint32_t VariableDataStore::decisionLevel() const {
 }
 
 inline uint32_t VariableDataStore::varDecisionLevel(Variable v) const {
-  return variable_data[v - 1].decision_level;
+  return variable_decision_level[v];
 }
 
 inline bool VariableDataStore::decisionLevelType(uint32_t decision_level) {
@@ -97,7 +96,7 @@ inline bool VariableDataStore::decisionLevelType(uint32_t decision_level) {
 }
 
 inline CRef VariableDataStore::varReason(Variable v) const {
-  return variable_data[v - 1].reason;
+  return variable_reason[v];
 }
 
 inline bool VariableDataStore::trailIsEmpty() const {
@@ -109,11 +108,30 @@ inline Variable VariableDataStore::lastVariable() const {
 }
 
 inline TrailIterator VariableDataStore::trailBegin() const {
-  return TrailIterator(&trail[0]);
+  return TrailIterator(trail.data());
 }
 
 inline TrailIterator VariableDataStore::trailEnd() const {
-  return TrailIterator(&trail[trail.size()]);
+  return TrailIterator(trail.data() + trail.size());
+}
+
+inline uint32_t VariableDataStore::trailSize() const {
+  return trail.size();
+}
+
+inline Literal VariableDataStore::trailLiteral(uint32_t position) const {
+  return trail[position];
+}
+
+inline uint32_t VariableDataStore::trailPosition(uint32_t decision_level) const {
+  // Position of the first literal on the trail whose decision level is at least decision_level.
+  if (decision_level == 0) {
+    return 0;
+  } else if (decision_level > decisionLevel()) {
+    return trail.size();
+  } else {
+    return decision_trail_positions[decision_level - 1];
+  }
 }
 
 inline string VariableDataStore::constraintToString(Constraint& constraint) const {
@@ -138,7 +156,7 @@ inline string VariableDataStore::literalVectorToString(vector<Literal>& literal_
 }
 
 inline bool VariableDataStore::allAssigned() const {
-  return trail.size() == variable_data.size();
+  return trail.size() == static_cast<size_t>(last_variable);
 }
 
 }
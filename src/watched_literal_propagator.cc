@@ -3,7 +3,7 @@
 
 namespace Qute {
 
-WatchedLiteralPropagator::WatchedLiteralPropagator(QCDCL_solver& solver, bool model_generation_approx_hs, double exponent, double scaling_factor, double universal_penalty): solver(solver), constraints_watched_by{vector<vector<WatchedRecord>>(2), vector<vector<WatchedRecord>>(2)}, exponent(exponent), scaling_factor(scaling_factor), universal_penalty(universal_penalty) {
+WatchedLiteralPropagator::WatchedLiteralPropagator(QCDCL_solver& solver, bool model_generation_approx_hs, double exponent, double scaling_factor, double universal_penalty, bool trail_saving): solver(solver), propagation_head(0), constraints_watched_by{vector<vector<WatchedRecord>>(2), vector<vector<WatchedRecord>>(2)}, unwatched_rescan_needed(true), unwatched_scan_level(0), trail_saving(trail_saving), saved_trail_head(0), exponent(exponent), scaling_factor(scaling_factor), universal_penalty(universal_penalty) {
   if (model_generation_approx_hs) {
     generateModel = &WatchedLiteralPropagator::generateModelApproxHittingSet;
   } else {
@@ -72,64 +72,41 @@ void WatchedLiteralPropagator::notifyStart() {
     double penalty = (qtype == 1) ? universal_penalty : 0.0;
     variable_weights.push_back(scaling_factor*std::pow(cost, exponent) + 1 + penalty);
   }
+  for (ConstraintType constraint_type: constraint_types) {
+    watchInputConstraints(constraint_type);
+  }
 }
 
 CRef WatchedLiteralPropagator::propagate(ConstraintType& constraint_type) {
-  if (solver.variable_data_store->decisionLevel() == 0) {
-    for (ConstraintType _constraint_type: constraint_types) {
-      vector<CRef>::iterator i, j;
-      for (i = j = constraints_without_two_watchers[_constraint_type].begin(); i != constraints_without_two_watchers[_constraint_type].end(); ++i) {
-        bool watchers_found = false;
-        if (!propagateUnwatched(*i, _constraint_type, watchers_found)) {
-          CRef empty_constraint_reference = *i;
-           // Constraint is empty: clean up, return constraint_reference.
-          for (; i != constraints_without_two_watchers[_constraint_type].end(); i++, j++) {
-            *j = *i;
-          }
-          constraints_without_two_watchers[_constraint_type].resize(j - constraints_without_two_watchers[_constraint_type].begin(), CRef_Undef);
-          constraint_type = _constraint_type;
-          return empty_constraint_reference;
-        } else if (!watchers_found) {
-          *j++ = *i;
-        }
-      }
-      constraints_without_two_watchers[_constraint_type].resize(j - constraints_without_two_watchers[_constraint_type].begin(), CRef_Undef);
+  CRef conflict_constraint_reference;
+  if (unwatched_rescan_needed) {
+    /* After a scan, every constraint without two watchers is disabled or has found its watchers. This only changes
+       if a constraint is added to the list or if backtracking undoes the decision level of the scan. */
+    unwatched_rescan_needed = false;
+    unwatched_scan_level = solver.variable_data_store->decisionLevel();
+    if ((conflict_constraint_reference = propagateUnwatchedConstraints<ConstraintType::clauses>()) != CRef_Undef) {
+      constraint_type = ConstraintType::clauses;
+      return conflict_constraint_reference;
+    }
+    if ((conflict_constraint_reference = propagateUnwatchedConstraints<ConstraintType::terms>()) != CRef_Undef) {
+      constraint_type = ConstraintType::terms;
+      return conflict_constraint_reference;
     }
   }
-  while (!propagation_queue.empty()) {
-    Literal to_propagate = propagation_queue.back();
-    propagation_queue.pop_back();
+  // Literals are propagated in the order in which they were assigned.
+  while (propagation_head < solver.variable_data_store->trailSize()) {
+    Literal to_propagate = solver.variable_data_store->trailLiteral(propagation_head++);
     //LOG(trace) << "Propagating literal: " << (sign(to_propagate) ? "" : "-") << var(to_propagate) << std::endl;
-    for (ConstraintType _constraint_type: constraint_types) {
-      Literal watcher = ~(to_propagate ^ _constraint_type);
-      vector<WatchedRecord>& record_vector = constraints_watched_by[_constraint_type][toInt(watcher)];
-      vector<WatchedRecord>::iterator i, j;
-      for (i = j = record_vector.begin(); i != record_vector.end(); ++i) {
-        WatchedRecord& record = *i;
-        CRef constraint_reference = record.constraint_reference;
-        Literal blocker = record.blocker;
-        bool watcher_changed = false;
-        if (!disablesConstraint(blocker, _constraint_type)) {
-          Constraint& constraint = solver.constraint_database->getConstraint(constraint_reference, _constraint_type);
-          if (constraintIsWatchedByLiteral(constraint, watcher)) { // if we want to allow for removal, add "&& !constraint.isMarked()"
-            if (!updateWatchedLiterals(constraint, constraint_reference, _constraint_type, watcher_changed)) {
-              // Constraint is empty: clean up, return constraint_reference.
-              for (; i != record_vector.end(); i++, j++) {
-                *j = *i;
-              }
-              record_vector.resize(j - record_vector.begin(), WatchedRecord(CRef_Undef, Literal_Undef));
-              constraint_type = _constraint_type;
-              return constraint_reference;
-            }
-          } else {
-            watcher_changed = true;
-          }
-        }
-        if (!watcher_changed) {
-          *j++ = record;
-        }
-      }
-      record_vector.resize(j - record_vector.begin(), WatchedRecord(CRef_Undef, Literal_Undef));
+    if ((conflict_constraint_reference = propagateLiteral<ConstraintType::clauses>(to_propagate)) != CRef_Undef) {
+      constraint_type = ConstraintType::clauses;
+      return conflict_constraint_reference;
+    }
+    if ((conflict_constraint_reference = propagateLiteral<ConstraintType::terms>(to_propagate)) != CRef_Undef) {
+      constraint_type = ConstraintType::terms;
+      return conflict_constraint_reference;
+    }
+    if (saved_trail_head < saved_trail.size()) {
+      replaySavedTrail(to_propagate);
     }
   }
   assert(propagationCorrect());
@@ -148,6 +125,147 @@ CRef WatchedLiteralPropagator::propagate(ConstraintType& constraint_type) {
   }
 }
 
+template <ConstraintType constraint_type> CRef WatchedLiteralPropagator::propagateUnwatchedConstraints() {
+  vector<CRef>::iterator i, j;
+  for (i = j = constraints_without_two_watchers[constraint_type].begin(); i != constraints_without_two_watchers[constraint_type].end(); ++i) {
+    bool watchers_found = false;
+    if (solver.constraint_database->getConstraint(*i, constraint_type).isMarked()) {
+      // Constraint has been removed from the database, drop it.
+      continue;
+    }
+    if (!propagateUnwatched<constraint_type>(*i, watchers_found)) {
+      CRef empty_constraint_reference = *i;
+       // Constraint is empty: clean up, return constraint_reference.
+      for (; i != constraints_without_two_watchers[constraint_type].end(); i++, j++) {
+        *j = *i;
+      }
+      constraints_without_two_watchers[constraint_type].resize(j - constraints_without_two_watchers[constraint_type].begin(), CRef_Undef);
+      return empty_constraint_reference;
+    } else if (!watchers_found) {
+      *j++ = *i;
+    }
+  }
+  constraints_without_two_watchers[constraint_type].resize(j - constraints_without_two_watchers[constraint_type].begin(), CRef_Undef);
+  return CRef_Undef;
+}
+
+template <ConstraintType constraint_type> CRef WatchedLiteralPropagator::propagateLiteral(Literal to_propagate) {
+  Literal watcher = ~(to_propagate ^ constraint_type);
+  vector<WatchedRecord>& record_vector = constraints_watched_by[constraint_type][toInt(watcher)];
+  vector<WatchedRecord>::iterator i, j;
+  for (i = j = record_vector.begin(); i != record_vector.end(); ++i) {
+    WatchedRecord& record = *i;
+    CRef constraint_reference = record.constraint_reference;
+    Literal blocker = record.blocker();
+    bool watcher_changed = false;
+    bool constraint_empty = false;
+    if (!disablesConstraint<constraint_type>(blocker)) {
+      if (record.binary()) {
+        // The blocker of a binary constraint is its other literal, no need to look at the constraint.
+        constraint_empty = !propagateBinary<constraint_type>(constraint_reference, blocker);
+      } else {
+        Constraint& constraint = solver.constraint_database->getConstraint(constraint_reference, constraint_type);
+        if (constraintIsWatchedByLiteral(constraint, watcher) && !constraint.isMarked()) { // Records of removed constraints are dropped.
+          constraint_empty = !updateWatchedLiterals<constraint_type>(constraint, constraint_reference, blocker, watcher_changed);
+          record.setBlocker(blocker);
+        } else {
+          watcher_changed = true;
+        }
+      }
+    }
+    if (constraint_empty) {
+      // Constraint is empty: clean up, return constraint_reference.
+      for (; i != record_vector.end(); i++, j++) {
+        *j = *i;
+      }
+      record_vector.resize(j - record_vector.begin(), WatchedRecord(CRef_Undef, Literal_Undef));
+      return constraint_reference;
+    }
+    if (!watcher_changed) {
+      *j++ = record;
+    }
+  }
+  record_vector.resize(j - record_vector.begin(), WatchedRecord(CRef_Undef, Literal_Undef));
+  return CRef_Undef;
+}
+
+void WatchedLiteralPropagator::notifyBacktrack(uint32_t decision_level_before) {
+  // Every literal remaining on the trail after backtracking has already been propagated.
+  propagation_head = solver.variable_data_store->trailSize();
+  if (decision_level_before <= unwatched_scan_level) {
+    unwatched_rescan_needed = true;
+  }
+}
+
+void WatchedLiteralPropagator::saveTrail(uint32_t decision_level_before) {
+  saved_trail.clear();
+  saved_trail_head = 0;
+  if (!trail_saving) {
+    return;
+  }
+  for (uint32_t position = solver.variable_data_store->trailPosition(decision_level_before); position < solver.variable_data_store->trailSize(); position++) {
+    Literal l = solver.variable_data_store->trailLiteral(position);
+    saved_trail.emplace_back(l, solver.variable_data_store->varReason(var(l)));
+  }
+}
+
+void WatchedLiteralPropagator::replaySavedTrail(Literal propagated) {
+  /* Once the decision of a saved decision level has been propagated again, the implied assignments
+     saved after it are replayed up to the next saved decision. An assignment is only replayed if its
+     reason is unit under the current assignment, which costs one pass over the reason instead of
+     the watcher updates that led to it. Assignments whose reasons are no longer unit (such as the one
+     that caused the dependency learning backtrack) are skipped. */
+  if (saved_trail[saved_trail_head].literal != propagated) {
+    if (solver.variable_data_store->varReason(var(propagated)) == CRef_Undef) {
+      // A different decision has been made, so the saved trail is no longer useful.
+      saved_trail.clear();
+      saved_trail_head = 0;
+    }
+    return;
+  }
+  for (saved_trail_head++; saved_trail_head < saved_trail.size(); saved_trail_head++) {
+    SavedAssignment& saved = saved_trail[saved_trail_head];
+    if (saved.constraint_reference == CRef_Undef) {
+      break;
+    }
+    Variable v = var(saved.literal);
+    if (solver.variable_data_store->isAssigned(v)) {
+      continue;
+    }
+    ConstraintType constraint_type = static_cast<ConstraintType>(solver.variable_data_store->varType(v));
+    Constraint& constraint = solver.constraint_database->getConstraint(saved.constraint_reference, constraint_type);
+    if (!constraint.isMarked() && isReasonFor(constraint, constraint_type, saved.literal ^ constraint_type)) {
+      solver.enqueue(saved.literal, saved.constraint_reference);
+      solver.solver_statistics.nr_replayed++;
+    }
+  }
+}
+
+bool WatchedLiteralPropagator::isReasonFor(Constraint& constraint, ConstraintType constraint_type, Literal primary) {
+  /* The implied primary must be a watcher. It is moved to constraint[0] so that ConstraintDB::isLocked
+     recognizes the constraint as a reason; swapping the two watchers does not affect the watched records. */
+  uint32_t primary_index = 0;
+  if (constraint[0] != primary) {
+    if (constraint.size < 2 || constraint[1] != primary) {
+      return false;
+    }
+    primary_index = 1;
+  }
+  for (uint32_t i = 0; i < constraint.size; i++) {
+    if (i == primary_index) {
+      continue;
+    }
+    Literal l = constraint[i];
+    lbool value = solver.variable_data_store->literalValue(l);
+    if (value == lbool(disablingPolarity(constraint_type))) {
+      return false;
+    } else if (value == l_Undef && (solver.variable_data_store->varType(var(l)) == constraint_type || solver.dependency_manager->dependsOn(var(primary), var(l)))) {
+      return false;
+    }
+  }
+  std::swap(constraint[0], constraint[primary_index]);
+  return true;
+}
 
 void WatchedLiteralPropagator::generateModelSimple(vector<Literal>& model) {
   vector<bool> characteristic_function(solver.variable_data_store->lastVariable() + solver.variable_data_store->lastVariable() + 2);
@@ -157,9 +275,9 @@ void WatchedLiteralPropagator::generateModelSimple(vector<Literal>& model) {
        ++it) {
     CRef constraint_reference = *it;
     Constraint& input_clause = solver.constraint_database->getConstraint(constraint_reference, ConstraintType::clauses);
-    Literal disabling = findDisabling(input_clause, ConstraintType::clauses, false);
+    Literal disabling = findDisabling<ConstraintType::clauses>(input_clause, false);
     if (disabling == Literal_Undef) {
-      disabling = findDisabling(input_clause, ConstraintType::clauses, true);
+      disabling = findDisabling<ConstraintType::clauses>(input_clause, true);
     }
     characteristic_function[toInt(disabling)] = true;
   }
@@ -204,7 +322,7 @@ void WatchedLiteralPropagator::generateModelApproxHittingSet(vector<Literal>& mo
     bool already_covered = false;
     for (Literal lit : clause) {
       Variable litvar = var(lit);
-      if (disablesConstraint(lit, ConstraintType::clauses)) {
+      if (disablesConstraint<ConstraintType::clauses>(lit)) {
         if (litvar > last_universal) {
           already_covered = true;
           break;
@@ -264,7 +382,7 @@ void WatchedLiteralPropagator::generateModelApproxHittingSet(vector<Literal>& mo
         // if lit is satisfied, remove clause from the occurrences of lit,
         // because clause is now covered by current_var
         Variable litvar = var(lit);
-        if (litvar != current_var && disablesConstraint(lit, ConstraintType::clauses)) {
+        if (litvar != current_var && disablesConstraint<ConstraintType::clauses>(lit)) {
           if (helper_data[litvar][0] == 0) {
             // the variable has become affected now and must be
             // unlinked from its bucket and added to the list of
@@ -299,22 +417,61 @@ void WatchedLiteralPropagator::generateModelApproxHittingSet(vector<Literal>& mo
 
 void WatchedLiteralPropagator::addConstraint(CRef constraint_reference, ConstraintType constraint_type) {
   Constraint& constraint = solver.constraint_database->getConstraint(constraint_reference, constraint_type);
-  uint32_t first_watcher_index = findFirstWatcher(constraint, constraint_type);
-  if (first_watcher_index < constraint.size) {
-    std::swap(constraint[0], constraint[first_watcher_index]);
-  } else {
+  if (!selectWatchers(constraint, constraint_type)) {
     constraints_without_two_watchers[constraint_type].push_back(constraint_reference);
+    unwatched_rescan_needed = true;
     return;
   }
+  constraints_watched_by[constraint_type][toInt(constraint[0])].emplace_back(constraint_reference, constraint[1], constraint.size == 2);
+  constraints_watched_by[constraint_type][toInt(constraint[1])].emplace_back(constraint_reference, constraint[0], constraint.size == 2);
+}
+
+bool WatchedLiteralPropagator::selectWatchers(Constraint& constraint, ConstraintType constraint_type) {
+  // Moves two suitable watchers to the front of the constraint, if there are any.
+  uint32_t first_watcher_index = findFirstWatcher(constraint, constraint_type);
+  if (first_watcher_index >= constraint.size) {
+    return false;
+  }
+  std::swap(constraint[0], constraint[first_watcher_index]);
   uint32_t second_watcher_index = findSecondWatcher(constraint, constraint_type);
-  if (second_watcher_index < constraint.size) {
-    std::swap(constraint[1], constraint[second_watcher_index]);
-  } else {
-    constraints_without_two_watchers[constraint_type].push_back(constraint_reference);
-    return;
+  if (second_watcher_index >= constraint.size) {
+    return false;
+  }
+  std::swap(constraint[1], constraint[second_watcher_index]);
+  return true;
+}
+
+void WatchedLiteralPropagator::watchInputConstraints(ConstraintType constraint_type) {
+  /* Watchers of all input constraints are selected in one pass, which also counts the records per watch list,
+     so that the lists can be filled in a second pass without reallocation. Constraints without two watchers
+     are appended to constraints_without_two_watchers in input order, which lets the second pass skip them. */
+  vector<uint32_t> nr_records(constraints_watched_by[constraint_type].size(), 0);
+  size_t first_unwatched = constraints_without_two_watchers[constraint_type].size();
+  auto input_begin = solver.constraint_database->constraintReferencesBegin(constraint_type, false);
+  auto input_end = solver.constraint_database->constraintReferencesEnd(constraint_type, false);
+  for (auto it = input_begin; it != input_end; ++it) {
+    Constraint& constraint = solver.constraint_database->getConstraint(*it, constraint_type);
+    if (selectWatchers(constraint, constraint_type)) {
+      nr_records[toInt(constraint[0])]++;
+      nr_records[toInt(constraint[1])]++;
+    } else {
+      constraints_without_two_watchers[constraint_type].push_back(*it);
+      unwatched_rescan_needed = true;
+    }
+  }
+  for (unsigned literal_int = Min_Literal_Int; literal_int < nr_records.size(); literal_int++) {
+    constraints_watched_by[constraint_type][literal_int].reserve(constraints_watched_by[constraint_type][literal_int].size() + nr_records[literal_int]);
+  }
+  size_t next_unwatched = first_unwatched;
+  for (auto it = input_begin; it != input_end; ++it) {
+    if (next_unwatched < constraints_without_two_watchers[constraint_type].size() && constraints_without_two_watchers[constraint_type][next_unwatched] == *it) {
+      next_unwatched++;
+      continue;
+    }
+    Constraint& constraint = solver.constraint_database->getConstraint(*it, constraint_type);
+    constraints_watched_by[constraint_type][toInt(constraint[0])].emplace_back(*it, constraint[1], constraint.size == 2);
+    constraints_watched_by[constraint_type][toInt(constraint[1])].emplace_back(*it, constraint[0], constraint.size == 2);
   }
-  constraints_watched_by[constraint_type][toInt(constraint[0])].emplace_back(constraint_reference, constraint[1]);
-  constraints_watched_by[constraint_type][toInt(constraint[1])].emplace_back(constraint_reference, constraint[0]);
 }
 
 void WatchedLiteralPropagator::relocConstraintReferences(ConstraintType constraint_type) {
@@ -340,21 +497,32 @@ void WatchedLiteralPropagator::relocConstraintReferences(ConstraintType constrai
     }
   }
   constraints_without_two_watchers[constraint_type].resize(j - constraints_without_two_watchers[constraint_type].begin());
+  for (uint32_t k = saved_trail_head; k < saved_trail.size(); k++) {
+    SavedAssignment& saved = saved_trail[k];
+    if (saved.constraint_reference != CRef_Undef && solver.variable_data_store->varType(var(saved.literal)) == constraint_type) {
+      if (solver.constraint_database->getConstraint(saved.constraint_reference, constraint_type).isMarked()) {
+        // The reason has been removed, so the rest of the saved trail cannot be replayed.
+        saved_trail.resize(k, SavedAssignment(Literal_Undef, CRef_Undef));
+        break;
+      }
+      solver.constraint_database->relocate(saved.constraint_reference, constraint_type);
+    }
+  }
 }
 
-bool WatchedLiteralPropagator::propagateUnwatched(CRef constraint_reference, ConstraintType constraint_type, bool& watchers_found) {
+template <ConstraintType constraint_type> bool WatchedLiteralPropagator::propagateUnwatched(CRef constraint_reference, bool& watchers_found) {
   Constraint& constraint = solver.constraint_database->getConstraint(constraint_reference, constraint_type);
-  if ((constraint.size == 0 || solver.variable_data_store->varType(var(constraint[0])) != constraint_type) && !isDisabled(constraint, constraint_type)) {
+  if ((constraint.size == 0 || solver.variable_data_store->varType(var(constraint[0])) != constraint_type) && !isDisabled<constraint_type>(constraint)) {
     //LOG(trace) << (constraint_type ? "Term " : "Clause ") << "empty: " << solver.variable_data_store->constraintToString(constraint) << std::endl;
     assert(solver.debug_helper->isEmpty(constraint, constraint_type));
     return false;
-  } else if (!isDisabled(constraint, constraint_type)) { // First watcher is a primary literal and constraint is not disabled. 
+  } else if (!isDisabled<constraint_type>(constraint)) { // First watcher is a primary literal and constraint is not disabled. 
     uint32_t second_watcher_index = findSecondWatcher(constraint, constraint_type);
     if (second_watcher_index < constraint.size) {
       std::swap(constraint[1], constraint[second_watcher_index]);
       watchers_found = true;
-      constraints_watched_by[constraint_type][toInt(constraint[0])].emplace_back(constraint_reference, constraint[1]);
-      constraints_watched_by[constraint_type][toInt(constraint[1])].emplace_back(constraint_reference, constraint[0]);
+      constraints_watched_by[constraint_type][toInt(constraint[0])].emplace_back(constraint_reference, constraint[1], constraint.size == 2);
+      constraints_watched_by[constraint_type][toInt(constraint[1])].emplace_back(constraint_reference, constraint[0], constraint.size == 2);
       return true;
     } else {
       assert(solver.debug_helper->isEmpty(constraint, constraint_type) || solver.debug_helper->isUnit(constraint, constraint_type));
@@ -365,9 +533,13 @@ bool WatchedLiteralPropagator::propagateUnwatched(CRef constraint_reference, Con
   return true;
 }
 
-bool WatchedLiteralPropagator::updateWatchedLiterals(Constraint& constraint, CRef constraint_reference, ConstraintType constraint_type, bool& watcher_changed) {
+template <ConstraintType constraint_type> bool WatchedLiteralPropagator::updateWatchedLiterals(Constraint& constraint, CRef constraint_reference, Literal& blocker, bool& watcher_changed) {
+  /* Disabling literals are detected during the search for new watchers, so that the constraint is only traversed once.
+     A disabling literal becomes the blocker of the current record, which is kept in any case because the watcher
+     it belongs to may still be in place. Before a constraint is found to be unit or empty, every literal has been checked. */
   watcher_changed = false;
-  if (isDisabled(constraint, constraint_type)) {
+  if (disablesConstraint<constraint_type>(constraint[0]) || disablesConstraint<constraint_type>(constraint[1])) {
+    blocker = disablesConstraint<constraint_type>(constraint[0]) ? constraint[0] : constraint[1];
     return true;
   }
   /* If both watchers must be updated, it can happen that the first watcher can be updated, but not the second.
@@ -382,10 +554,17 @@ bool WatchedLiteralPropagator::updateWatchedLiterals(Constraint& constraint, CRe
        If the second watcher (constraint[1]) is a primary that is assigned or a secondary,
        we _must_ find a new unassigned primary or a disabling literal unless the constraint is empty. */
     if (solver.variable_data_store->varType(var(constraint[1])) != constraint_type || solver.variable_data_store->isAssigned(var(constraint[1]))) {
-      for (i = 2; i < constraint.size; i++) {
-        if (isUnassignedPrimary(constraint[i], constraint_type)) {
+      // The search for a new first watcher resumes where the last search ended.
+      uint32_t start = searchStart(constraint);
+      i = start;
+      for (uint32_t k = 2; k < constraint.size; k++, i = nextSearchIndex(constraint, i, start)) {
+        if (disablesConstraint<constraint_type>(constraint[i])) {
+          blocker = constraint[i];
+          return true;
+        } else if (isUnassignedPrimary<constraint_type>(constraint[i])) {
+          saveSearchPosition(constraint, i);
           std::swap(constraint[0], constraint[i]);
-          constraints_watched_by[constraint_type][toInt(constraint[0])].emplace_back(constraint_reference, constraint[1]);
+          constraints_watched_by[constraint_type][toInt(constraint[0])].emplace_back(constraint_reference, constraint[1], constraint.size == 2);
           watcher_changed = true;
           break;
         }
@@ -402,18 +581,27 @@ bool WatchedLiteralPropagator::updateWatchedLiterals(Constraint& constraint, CRe
     }
   }
   // The second watcher (constraint[1]) must be updated, and the first watcher is an unassigned primary.
-  for (unsigned i = 1; i < constraint.size; i++) {
-    if (isUnassignedPrimary(constraint[i], constraint_type)) {
-      assert(!solver.debug_helper->isEmpty(constraint, constraint_type) && !solver.debug_helper->isUnit(constraint, constraint_type));
+  uint32_t start = searchStart(constraint);
+  for (uint32_t k = 1, j = 1; k < constraint.size; k++, j = nextSearchIndex(constraint, j, start)) {
+    if (disablesConstraint<constraint_type>(constraint[j])) {
+      // Keep the old first watcher as the second watcher, see above.
+      blocker = constraint[j];
       std::swap(constraint[1], constraint[i]);
-      constraints_watched_by[constraint_type][toInt(constraint[1])].emplace_back(constraint_reference, constraint[0]);
+      watcher_changed = false;
+      return true;
+    } else if (isUnassignedPrimary<constraint_type>(constraint[j])) {
+      assert(!solver.debug_helper->isEmpty(constraint, constraint_type) && !solver.debug_helper->isUnit(constraint, constraint_type));
+      saveSearchPosition(constraint, j);
+      std::swap(constraint[1], constraint[j]);
+      constraints_watched_by[constraint_type][toInt(constraint[1])].emplace_back(constraint_reference, constraint[0], constraint.size == 2);
       watcher_changed = true;
       return true;
-    } else if (isBlockedSecondary(constraint[i], constraint_type, constraint[0])) {
+    } else if (isBlockedSecondary<constraint_type>(constraint[j], constraint[0])) {
       assert(!solver.debug_helper->isEmpty(constraint, constraint_type) && !solver.debug_helper->isUnit(constraint, constraint_type));
-      // Make constraint[i] the second watcher.
-      std::swap(constraint[1], constraint[i]);
-      constraints_watched_by[constraint_type][toInt(constraint[1])].emplace_back(constraint_reference, constraint[0]);
+      // Make constraint[j] the second watcher.
+      saveSearchPosition(constraint, j);
+      std::swap(constraint[1], constraint[j]);
+      constraints_watched_by[constraint_type][toInt(constraint[1])].emplace_back(constraint_reference, constraint[0], constraint.size == 2);
       watcher_changed = true;
       return true;
     }
@@ -426,6 +614,20 @@ bool WatchedLiteralPropagator::updateWatchedLiterals(Constraint& constraint, CRe
   return solver.enqueue(constraint[0] ^ constraint_type, constraint_reference);
 }
 
+template <ConstraintType constraint_type> bool WatchedLiteralPropagator::propagateBinary(CRef constraint_reference, Literal other) {
+  /* The watcher of a binary constraint has been assigned and "other" does not disable the constraint.
+     If "other" is an unassigned primary, it is unit. Otherwise, "other" is either assigned or a blocked
+     secondary the (assigned) primary watcher depends on, so the constraint is empty. The literals are
+     not reordered, which is why ConstraintDB::isLocked checks both literals of binary constraints. */
+  assert(solver.debug_helper->isEmpty(solver.constraint_database->getConstraint(constraint_reference, constraint_type), constraint_type) ||
+         solver.debug_helper->isUnit(solver.constraint_database->getConstraint(constraint_reference, constraint_type), constraint_type));
+  if (isUnassignedPrimary<constraint_type>(other)) {
+    return solver.enqueue(other ^ constraint_type, constraint_reference);
+  } else {
+    return false;
+  }
+}
+
 inline uint32_t WatchedLiteralPropagator::findFirstWatcher(Constraint& constraint, ConstraintType constraint_type) {
   uint32_t i;
   for (i = 0; i < constraint.size; i++) {
@@ -464,16 +666,15 @@ inline uint32_t WatchedLiteralPropagator::findSecondWatcher(Constraint& constrai
 }
 
 bool WatchedLiteralPropagator::isUnassignedOrDisablingPrimary(Literal literal, ConstraintType constraint_type) {
+  // A literal is unassigned or disabling iff it does not have the value of the non-disabling polarity.
   return (solver.variable_data_store->varType(var(literal)) == constraint_type &&
-          (!solver.variable_data_store->isAssigned(var(literal)) ||
-           (solver.variable_data_store->assignment(var(literal)) == sign(literal)) == disablingPolarity(constraint_type)));
+          solver.variable_data_store->literalValue(literal) != lbool(!disablingPolarity(constraint_type)));
 }
 
 bool WatchedLiteralPropagator::isBlockedOrDisablingSecondary(Literal literal, ConstraintType constraint_type, Literal primary) {
   return ((solver.variable_data_store->varType(var(literal)) != constraint_type && solver.dependency_manager->dependsOn(var(primary), var(literal))) &&
-          (!solver.variable_data_store->isAssigned(var(literal)) ||
-           (solver.variable_data_store->assignment(var(literal)) == sign(literal)) == disablingPolarity(constraint_type) ||
-           ((solver.variable_data_store->assignment(var(primary)) == sign(literal)) == disablingPolarity(constraint_type) &&
+          (solver.variable_data_store->literalValue(literal) != lbool(!disablingPolarity(constraint_type)) ||
+           (solver.variable_data_store->literalValue(mkLiteral(var(primary), sign(literal))) == lbool(disablingPolarity(constraint_type)) &&
             solver.variable_data_store->varDecisionLevel(var(primary)) <= solver.variable_data_store->varDecisionLevel(var(literal)))));
 }
 
@@ -481,25 +682,25 @@ bool WatchedLiteralPropagator::constraintIsWatchedByLiteral(Constraint& constrai
   return (l == constraint[0]) || (l == constraint[1]);
 }
 
-bool WatchedLiteralPropagator::disablesConstraint(Literal literal, ConstraintType constraint_type) {
-  return solver.variable_data_store->isAssigned(var(literal)) && (solver.variable_data_store->assignment(var(literal)) == sign(literal)) == disablingPolarity(constraint_type);
+template <ConstraintType constraint_type> bool WatchedLiteralPropagator::disablesConstraint(Literal literal) {
+  return solver.variable_data_store->literalValue(literal) == lbool(disablingPolarity(constraint_type));
 }
 
-bool WatchedLiteralPropagator::isDisabled(Constraint& constraint, ConstraintType constraint_type) {
+template <ConstraintType constraint_type> bool WatchedLiteralPropagator::isDisabled(Constraint& constraint) {
   for (unsigned i = 0; i < constraint.size; i++) {
-    if (disablesConstraint(constraint[i], constraint_type)) {
+    if (disablesConstraint<constraint_type>(constraint[i])) {
       return true;
     }
   }
   return false;
 }
 
-bool WatchedLiteralPropagator::isUnassignedPrimary(Literal literal, ConstraintType constraint_type) {
-  return solver.variable_data_store->varType(var(literal)) == constraint_type && !solver.variable_data_store->isAssigned(var(literal));
+template <ConstraintType constraint_type> bool WatchedLiteralPropagator::isUnassignedPrimary(Literal literal) {
+  return solver.variable_data_store->varType(var(literal)) == constraint_type && solver.variable_data_store->literalValue(literal) == l_Undef;
 }
 
-bool WatchedLiteralPropagator::isBlockedSecondary(Literal literal, ConstraintType constraint_type, Literal primary) {
-  return !solver.variable_data_store->isAssigned(var(literal)) && solver.dependency_manager->dependsOn(var(primary), var(literal));
+template <ConstraintType constraint_type> bool WatchedLiteralPropagator::isBlockedSecondary(Literal literal, Literal primary) {
+  return solver.variable_data_store->literalValue(literal) == l_Undef && solver.dependency_manager->dependsOn(var(primary), var(literal));
 }
 
 bool WatchedLiteralPropagator::propagationCorrect() {
@@ -519,10 +720,10 @@ bool WatchedLiteralPropagator::propagationCorrect() {
   return true;
 }
 
-Literal WatchedLiteralPropagator::findDisabling(Constraint& constraint, ConstraintType constraint_type, bool variable_type) {
+template <ConstraintType constraint_type> Literal WatchedLiteralPropagator::findDisabling(Constraint& constraint, bool variable_type) {
   for (Literal l: constraint) {
     auto v = var(l);
-    if (solver.variable_data_store->varType(v) == variable_type && disablesConstraint(l, constraint_type)) {
+    if (solver.variable_data_store->varType(v) == variable_type && disablesConstraint<constraint_type>(l)) {
       return l;
     }
   }
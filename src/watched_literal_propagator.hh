@@ -15,53 +15,91 @@ class WatchedLiteralPropagator: public Propagator {
   friend class DecisionHeuristic;
 
 public:
-  WatchedLiteralPropagator(QCDCL_solver& solver, bool model_generation_approx_hs, double exponent, double scaling_factor, double universal_penalty);
+  WatchedLiteralPropagator(QCDCL_solver& solver, bool model_generation_approx_hs, double exponent, double scaling_factor, double universal_penalty, bool trail_saving);
   virtual void addVariable();
   virtual CRef propagate(ConstraintType& constraint_type);
   virtual void addConstraint(CRef constraint_reference, ConstraintType constraint_type);
-  virtual void notifyAssigned(Literal l);
   virtual void notifyBacktrack(uint32_t decision_level_before);
+  virtual void saveTrail(uint32_t decision_level_before);
   virtual void notifyStart();
   virtual void relocConstraintReferences(ConstraintType constraint_type);
 
 protected:
   uint32_t findFirstWatcher(Constraint& constraint, ConstraintType constraint_type);
   uint32_t findSecondWatcher(Constraint& constraint, ConstraintType constraint_type);
+  bool selectWatchers(Constraint& constraint, ConstraintType constraint_type);
+  void watchInputConstraints(ConstraintType constraint_type);
   bool isUnassignedOrDisablingPrimary(Literal literal, ConstraintType constraint_type);
   bool isBlockedOrDisablingSecondary(Literal literal, ConstraintType constraint_type, Literal primary);
   bool constraintIsWatchedByLiteral(Constraint& constraint, Literal l);
-  bool disablesConstraint(Literal literal, ConstraintType constraint_type);
-  bool propagateUnwatched(CRef constraint_reference, ConstraintType constraint_type, bool& watchers_found);
-  bool isDisabled(Constraint& constraint, ConstraintType constraint_type);
-  bool isUnassignedPrimary(Literal literal, ConstraintType constraint_type);
-  bool isBlockedSecondary(Literal literal, ConstraintType constraint_type, Literal primary);
-  bool updateWatchedLiterals(Constraint& constraint, CRef constraint_reference, ConstraintType constraint_type, bool& watcher_changed);
+  uint32_t searchStart(Constraint& constraint);
+  uint32_t nextSearchIndex(Constraint& constraint, uint32_t index, uint32_t start);
+  void saveSearchPosition(Constraint& constraint, uint32_t index);
   bool propagationCorrect();
-  Literal findDisabling(Constraint& constraint, ConstraintType constraint_type, bool variable_type);
+  void replaySavedTrail(Literal propagated);
+  bool isReasonFor(Constraint& constraint, ConstraintType constraint_type, Literal primary);
+
+  /* Propagation is specialized for clauses and terms, so that the polarity checks
+     in its inner loops do not depend on a runtime constraint type. */
+  template <ConstraintType constraint_type> CRef propagateUnwatchedConstraints();
+  template <ConstraintType constraint_type> CRef propagateLiteral(Literal to_propagate);
+  template <ConstraintType constraint_type> bool disablesConstraint(Literal literal);
+  template <ConstraintType constraint_type> bool propagateUnwatched(CRef constraint_reference, bool& watchers_found);
+  template <ConstraintType constraint_type> bool isDisabled(Constraint& constraint);
+  template <ConstraintType constraint_type> bool isUnassignedPrimary(Literal literal);
+  template <ConstraintType constraint_type> bool isBlockedSecondary(Literal literal, Literal primary);
+  template <ConstraintType constraint_type> bool updateWatchedLiterals(Constraint& constraint, CRef constraint_reference, Literal& blocker, bool& watcher_changed);
+  template <ConstraintType constraint_type> bool propagateBinary(CRef constraint_reference, Literal other);
+  template <ConstraintType constraint_type> Literal findDisabling(Constraint& constraint, bool variable_type);
 
   void (WatchedLiteralPropagator::*generateModel)(vector<Literal>& model);
   void generateModelSimple(vector<Literal>& model);
   void generateModelApproxHittingSet(vector<Literal>& model);
 
+  /* For binary constraints, the blocker is always the other literal of the constraint,
+     so such records can be processed without accessing the constraint itself. Literal integers
+     are non-negative, so the binary flag is kept in the sign bit of the blocker, which keeps a
+     record at 8 bytes unless constraint references are 64 bits wide. */
   struct WatchedRecord
   {
     CRef constraint_reference;
-    Literal blocker;
+    uint32_t tagged_blocker;
 
-    WatchedRecord(CRef constraint_reference, Literal blocker): constraint_reference(constraint_reference), blocker(blocker) {}
+    static const uint32_t binary_tag = uint32_t(1) << 31;
+
+    WatchedRecord(CRef constraint_reference, Literal blocker, bool binary=false): constraint_reference(constraint_reference), tagged_blocker(uint32_t(toInt(blocker)) | (binary ? binary_tag : 0)) {}
+
+    Literal blocker() const { return toLiteral(tagged_blocker & ~binary_tag); }
+    bool binary() const { return tagged_blocker & binary_tag; }
+    void setBlocker(Literal blocker) { tagged_blocker = uint32_t(toInt(blocker)) | (tagged_blocker & binary_tag); }
 
     WatchedRecord& operator=(const WatchedRecord& other) {
       constraint_reference = other.constraint_reference;
-      blocker = other.blocker;
+      tagged_blocker = other.tagged_blocker;
       return *this;
     }
   };
 
+  /* An assignment undone by a dependency learning backtrack. Decisions have
+     constraint_reference == CRef_Undef. */
+  struct SavedAssignment
+  {
+    Literal literal;
+    CRef constraint_reference;
+
+    SavedAssignment(Literal literal, CRef constraint_reference): literal(literal), constraint_reference(constraint_reference) {}
+  };
+
   QCDCL_solver& solver;
 
-  vector<Literal> propagation_queue;
+  uint32_t propagation_head; // Literals on the trail before this position have been propagated.
   vector<vector<WatchedRecord>> constraints_watched_by[2];
   vector<CRef> constraints_without_two_watchers[2];
+  bool unwatched_rescan_needed;
+  uint32_t unwatched_scan_level; // Decision level at which constraints_without_two_watchers was last scanned.
+  bool trail_saving;
+  vector<SavedAssignment> saved_trail;
+  uint32_t saved_trail_head; // Entries of saved_trail before this position have been replayed or skipped.
   double exponent;
   double scaling_factor;
   double universal_penalty;
@@ -78,19 +116,31 @@ inline void WatchedLiteralPropagator::addVariable() {
   }
 }
 
-// inline void WatchedLiteralPropagator::removeConstraint(CRef constraint_reference, ConstraintType constraint_type) {
-//   Constraint& constraint = solver.constraint_database->getConstraint(constraint_reference, constraint_type);
-//   constraint.mark();
-// }
+inline uint32_t WatchedLiteralPropagator::searchStart(Constraint& constraint) {
+  return constraint.hasSearchPosition() ? constraint.searchPosition() : 2;
+}
 
-inline void WatchedLiteralPropagator::notifyAssigned(Literal l) {
-  propagation_queue.push_back(l);
+inline uint32_t WatchedLiteralPropagator::nextSearchIndex(Constraint& constraint, uint32_t index, uint32_t start) {
+  /* Watchers are searched circularly: constraint[1] (if considered at all) comes first, followed by the literals
+     from start to the end of the constraint and then those from constraint[2] up to start. */
+  if (index == 1) {
+    return start;
+  } else {
+    return index + 1 < constraint.size ? index + 1 : 2;
+  }
 }
 
-inline void WatchedLiteralPropagator::notifyBacktrack(uint32_t decision_level_before) {
-  propagation_queue.clear();
+inline void WatchedLiteralPropagator::saveSearchPosition(Constraint& constraint, uint32_t index) {
+  if (constraint.hasSearchPosition() && index >= 2) {
+    constraint.searchPosition() = index;
+  }
 }
 
+// inline void WatchedLiteralPropagator::removeConstraint(CRef constraint_reference, ConstraintType constraint_type) {
+//   Constraint& constraint = solver.constraint_database->getConstraint(constraint_reference, constraint_type);
+//   constraint.mark();
+// }
+
 }
 
 #endif
\ No newline at end of file